@@ -0,0 +1,129 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-discord-rich-presence, a DLL Plugin for
+// SimCity 4 that implements Discord rich presence support.
+//
+// Copyright (c) 2024 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#include "ActivityUpdatePipeline.h"
+#include <algorithm>
+
+namespace
+{
+	// The Discord API requires a minimum of 5 seconds between activity updates.
+	constexpr std::chrono::seconds MinimumUpdateInterval(5);
+
+	constexpr std::chrono::seconds MaximumRetryDelay(60);
+}
+
+ActivityUpdatePipeline::ActivityUpdatePipeline(IDiscordActivitySender& client, const PresenceClock& clock)
+	: client(client),
+	  clock(clock),
+	  pendingActivity(),
+	  inFlightActivity(),
+	  inFlightRequestId(0),
+	  nextSendTime(),
+	  consecutiveFailures(0),
+	  hasPendingActivity(false),
+	  random(static_cast<uint32_t>(clock.GetSteadyTime().time_since_epoch().count()))
+{
+}
+
+void ActivityUpdatePipeline::Submit(const DiscordActivity& activity)
+{
+	pendingActivity = activity;
+	hasPendingActivity = true;
+}
+
+bool ActivityUpdatePipeline::CanSend() const
+{
+	return inFlightRequestId == 0 && clock.GetSteadyTime() >= nextSendTime && client.IsReady();
+}
+
+void ActivityUpdatePipeline::Send()
+{
+	if (hasPendingActivity && CanSend())
+	{
+		const PresenceClock::SteadyTimePoint now = clock.GetSteadyTime();
+		const uint64_t requestId = client.UpdateActivity(pendingActivity);
+
+		if (requestId != 0)
+		{
+			inFlightRequestId = requestId;
+			inFlightActivity = pendingActivity;
+			hasPendingActivity = false;
+			nextSendTime = now + MinimumUpdateInterval;
+		}
+		else
+		{
+			// The pending activity is kept for the retry.
+			ScheduleRetry(now);
+		}
+	}
+}
+
+void ActivityUpdatePipeline::RequestCompleted(uint64_t requestId, DiscordRequestResult result)
+{
+	if (requestId == 0 || requestId != inFlightRequestId)
+	{
+		return;
+	}
+
+	inFlightRequestId = 0;
+
+	if (result == DiscordRequestResult::Ok)
+	{
+		consecutiveFailures = 0;
+	}
+	else
+	{
+		// Retry the failed activity unless it has been superseded by a newer one.
+		if (!hasPendingActivity)
+		{
+			pendingActivity = inFlightActivity;
+			hasPendingActivity = true;
+		}
+
+		ScheduleRetry(clock.GetSteadyTime());
+	}
+}
+
+void ActivityUpdatePipeline::Reset()
+{
+	inFlightRequestId = 0;
+	consecutiveFailures = 0;
+	nextSendTime = PresenceClock::SteadyTimePoint();
+}
+
+void ActivityUpdatePipeline::ScheduleRetry(PresenceClock::SteadyTimePoint now)
+{
+	if (consecutiveFailures < 16)
+	{
+		consecutiveFailures++;
+	}
+
+	// The delay doubles after each failure, starting at the minimum update interval.
+	// A random amount of up to half of the delay is added so that the retries are
+	// spread out, the jitter never shortens the delay below the rate limit.
+	std::chrono::milliseconds delay = std::chrono::duration_cast<std::chrono::milliseconds>(MinimumUpdateInterval);
+
+	for (uint32_t i = 1; i < consecutiveFailures && delay < MaximumRetryDelay; i++)
+	{
+		delay *= 2;
+	}
+
+	if (delay > MaximumRetryDelay)
+	{
+		delay = MaximumRetryDelay;
+	}
+
+	std::uniform_int_distribution<int64_t> jitter(0, delay.count() / 2);
+	const std::chrono::milliseconds jitteredDelay(delay.count() + jitter(random));
+
+	nextSendTime = std::max(nextSendTime, now + jitteredDelay);
+}
@@ -0,0 +1,61 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-discord-rich-presence, a DLL Plugin for
+// SimCity 4 that implements Discord rich presence support.
+//
+// Copyright (c) 2024 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include "DiscordActivity.h"
+#include "DiscordRequestStats.h"
+#include "IDiscordActivitySender.h"
+#include "PresenceClock.h"
+#include <chrono>
+#include <cstdint>
+#include <random>
+
+// Sends the activity updates to Discord.
+//
+// At most one request is in flight, and the activities that are submitted while
+// waiting are coalesced into a single pending activity, so only the most recent
+// activity is sent. A failed request is retried with a jittered exponential
+// backoff unless a newer activity has been submitted.
+class ActivityUpdatePipeline
+{
+public:
+	ActivityUpdatePipeline(IDiscordActivitySender& client, const PresenceClock& clock);
+
+	// Replaces the pending activity.
+	void Submit(const DiscordActivity& activity);
+
+	// Returns true if a submitted activity would be sent now.
+	bool CanSend() const;
+
+	// Sends the pending activity if there is no request in flight and the
+	// rate limit or retry backoff has elapsed.
+	void Send();
+
+	// Called by the client when Discord responds to a request.
+	void RequestCompleted(uint64_t requestId, DiscordRequestResult result);
+
+	// Discards the in-flight request and backoff state after the connection is reset.
+	void Reset();
+
+private:
+	void ScheduleRetry(PresenceClock::SteadyTimePoint now);
+
+	IDiscordActivitySender& client;
+	const PresenceClock& clock;
+	DiscordActivity pendingActivity;
+	DiscordActivity inFlightActivity;
+	uint64_t inFlightRequestId;
+	PresenceClock::SteadyTimePoint nextSendTime;
+	uint32_t consecutiveFailures;
+	bool hasPendingActivity;
+	std::minstd_rand random;
+};
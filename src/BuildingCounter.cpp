@@ -0,0 +1,57 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-discord-rich-presence, a DLL Plugin for
+// SimCity 4 that implements Discord rich presence support.
+//
+// Copyright (c) 2024 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#include "BuildingCounter.h"
+
+BuildingCounter::BuildingCounter()
+	: count(0),
+	  active(false)
+{
+}
+
+void BuildingCounter::Start(int32_t scannedCount)
+{
+	count = scannedCount;
+	active = true;
+}
+
+void BuildingCounter::Stop()
+{
+	active = false;
+}
+
+bool BuildingCounter::OccupantInserted(uint32_t occupantType)
+{
+	if (!active || occupantType != BuildingOccupantType)
+	{
+		return false;
+	}
+
+	count++;
+	return true;
+}
+
+bool BuildingCounter::OccupantRemoved(uint32_t occupantType)
+{
+	if (!active || occupantType != BuildingOccupantType || count == 0)
+	{
+		return false;
+	}
+
+	count--;
+	return true;
+}
+
+int32_t BuildingCounter::GetCount() const
+{
+	return count;
+}
@@ -0,0 +1,42 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-discord-rich-presence, a DLL Plugin for
+// SimCity 4 that implements Discord rich presence support.
+//
+// Copyright (c) 2024 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <cstdint>
+
+// Keeps the city's building count current from the occupant insert and remove
+// messages, so the occupants are only scanned once when the city is loaded.
+class BuildingCounter
+{
+public:
+	static constexpr uint32_t BuildingOccupantType = 0x278128A0;
+
+	BuildingCounter();
+
+	// Starts counting from the result of a full occupant scan.
+	// The occupants that the game inserts while loading the city are part of
+	// that scan, so the messages are ignored until this is called.
+	void Start(int32_t scannedCount);
+
+	// Stops counting before the game removes the city's occupants.
+	void Stop();
+
+	// Returns true if the occupant is a building and the count changed.
+	bool OccupantInserted(uint32_t occupantType);
+	bool OccupantRemoved(uint32_t occupantType);
+
+	int32_t GetCount() const;
+
+private:
+	int32_t count;
+	bool active;
+};
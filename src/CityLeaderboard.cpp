@@ -0,0 +1,68 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-discord-rich-presence, a DLL Plugin for
+// SimCity 4 that implements Discord rich presence support.
+//
+// Copyright (c) 2024 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#include "CityLeaderboard.h"
+
+CityLeaderboard::CityLeaderboard()
+	: rankedEntries(),
+	  cityValues()
+{
+}
+
+void CityLeaderboard::Update(uint32_t cityId, int64_t value)
+{
+	auto it = cityValues.find(cityId);
+
+	if (it != cityValues.end())
+	{
+		if (it->second == value)
+		{
+			return;
+		}
+
+		rankedEntries.erase(Entry{ cityId, it->second });
+		it->second = value;
+	}
+	else
+	{
+		cityValues.emplace(cityId, value);
+	}
+
+	rankedEntries.insert(Entry{ cityId, value });
+}
+
+void CityLeaderboard::Remove(uint32_t cityId)
+{
+	auto it = cityValues.find(cityId);
+
+	if (it != cityValues.end())
+	{
+		rankedEntries.erase(Entry{ cityId, it->second });
+		cityValues.erase(it);
+	}
+}
+
+size_t CityLeaderboard::GetCount() const
+{
+	return cityValues.size();
+}
+
+bool CityLeaderboard::GetLeader(Entry& entry) const
+{
+	if (rankedEntries.empty())
+	{
+		return false;
+	}
+
+	entry = *rankedEntries.begin();
+	return true;
+}
@@ -0,0 +1,62 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-discord-rich-presence, a DLL Plugin for
+// SimCity 4 that implements Discord rich presence support.
+//
+// Copyright (c) 2024 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <set>
+#include <unordered_map>
+
+// Ranks the cities in a region by a single value.
+//
+// The ranking is updated one city at a time, a city whose value has not changed
+// is not moved and a changed value only moves that city. This keeps the ranking
+// correct when a value decreases, which a bounded top-K heap cannot do without
+// rescanning every city.
+class CityLeaderboard
+{
+public:
+	struct Entry
+	{
+		uint32_t cityId;
+		int64_t value;
+	};
+
+	CityLeaderboard();
+
+	void Update(uint32_t cityId, int64_t value);
+
+	void Remove(uint32_t cityId);
+
+	size_t GetCount() const;
+
+	// Gets the city with the highest value, ties are ordered by the city id.
+	// Returns false if the leaderboard is empty.
+	bool GetLeader(Entry& entry) const;
+
+private:
+	struct EntryComparer
+	{
+		bool operator()(const Entry& lhs, const Entry& rhs) const
+		{
+			if (lhs.value != rhs.value)
+			{
+				return lhs.value > rhs.value;
+			}
+
+			return lhs.cityId < rhs.cityId;
+		}
+	};
+
+	std::set<Entry, EntryComparer> rankedEntries;
+	std::unordered_map<uint32_t, int64_t> cityValues;
+};
@@ -11,69 +11,128 @@
 ////////////////////////////////////////////////////////////////////////
 
 #include "CityStatusProvider.h"
+#include "GridStatistics.h"
+#include "Utf8Text.h"
 #include "cIGZMessage2Standard.h"
 #include "cIGZMessageServer2.h"
 #include "cISC4App.h"
 #include "cISC4AuraSimulator.h"
 #include "cISC4BudgetSimulator.h"
 #include "cISC4City.h"
+#include "cISC4CivicBuildingSimulator.h"
 #include "cISC4Demand.h"
 #include "cISC4DemandSimulator.h"
+#include "cISC4DepartmentBudget.h"
+#include "cISC4LotManager.h"
+#include "cISC4Occupant.h"
+#include "cISC4OccupantManager.h"
+#include "cISC4PoliceSimulator.h"
+#include "cISC4PollutionSimulator.h"
 #include "cISC4Region.h"
 #include "cISC4ResidentialSimulator.h"
 #include "cISC4Simulator.h"
+#include "cSC4OccupantTypeFilter.h"
 #include "GZCLSIDDefs.h"
 #include "GZServPtrs.h"
 #include <array>
-#include <vector>
 
 static constexpr uint32_t kSC4MessageFundsChanged = 0x772FAD4;
 static constexpr uint32_t kSC4MessageMayorNameChanged = 0xAB99381;
 static constexpr uint32_t kSC4MessageSimNewMonth = 0x66956816;
 static constexpr uint32_t kSC4MessageSimNewYear = 0x66956817;
 static constexpr uint32_t kSC4MessageHistoryWarehouseRecordChanged = 0x89EFA536; // Same as kSC4CLSID_cSC4HistoryWarehouse
+static constexpr uint32_t kSC4MessageInsertOccupant = 0x99EF1142;
+static constexpr uint32_t kSC4MessageRemoveOccupant = 0x99EF1143;
+static constexpr uint32_t kSC4MessagePreCityShutdown = 0x26D31EC2;
 
 constexpr int32_t kSC4StartYear = 2000; // SC4 starts in the year 2000.
 
-static const std::array<uint32_t, 5> MessageIds =
+// The pollution types used by cISC4PollutionSimulator::GetPollutionGrid.
+constexpr uint32_t kAirPollution = 0;
+constexpr uint32_t kWaterPollution = 1;
+
+static const std::array<uint32_t, 8> MessageIds =
 {
 	kSC4MessageFundsChanged,
 	kSC4MessageMayorNameChanged,
 	kSC4MessageSimNewMonth,
 	kSC4MessageSimNewYear,
 	kSC4MessageHistoryWarehouseRecordChanged,
+	kSC4MessageInsertOccupant,
+	kSC4MessageRemoveOccupant,
+	kSC4MessagePreCityShutdown,
 };
 
-static const std::vector<uint32_t> CommercialDemandIds =
+// The demand IDs that are queried for each CensusType value.
+static constexpr std::array<uint32_t, static_cast<size_t>(CityStatusProvider::CensusType::Count)> CensusDemandIds =
 {
-	0x3111,
-	0x3121,
-	0x3131,
-	0x3321,
-	0x3331,
-};
-
-static const std::vector<uint32_t> IndustrialDemandIds =
-{
-	0x4101,
-	0x4201,
-	0x4301,
-	0x4401,
+	0x1011, // R$
+	0x1021, // R$$
+	0x1031, // R$$$
+	0x3111, // CS$
+	0x3121, // CS$$
+	0x3131, // CS$$$
+	0x3321, // CO$$
+	0x3331, // CO$$$
+	0x4101, // I-R
+	0x4201, // I-D
+	0x4301, // I-M
+	0x4401, // I-HT
 };
 
 namespace
 {
-	int32_t GetTotalJobsBySensus(cISC4DemandSimulator& demandSim, std::vector<uint32_t> demandIds)
+	constexpr size_t ToIndex(CityStatusProvider::CensusType type)
+	{
+		return static_cast<size_t>(type);
+	}
+
+	int32_t SumCensusRange(
+		const std::array<int32_t, static_cast<size_t>(CityStatusProvider::CensusType::Count)>& census,
+		CityStatusProvider::CensusType first,
+		CityStatusProvider::CensusType last)
 	{
 		int32_t total = 0;
 
-		for (const auto& demandId : demandIds)
+		for (size_t i = ToIndex(first); i <= ToIndex(last); i++)
 		{
-			total += static_cast<int32_t>(demandSim.GetJobsBySensus(demandId));
+			total += census[i];
 		}
 
 		return total;
 	}
+
+	void ResetBudgetSnapshot(CityStatusProvider::BudgetSnapshot& budget)
+	{
+		budget.yearToDateIncome = 0;
+		budget.yearToDateExpenses = 0;
+		budget.estimatedIncome = 0;
+		budget.estimatedExpenses = 0;
+		budget.totalBorrowed = 0;
+		budget.monthlyLoanPayments = 0;
+		budget.largestDepartmentExpense = 0;
+		budget.largestExpenseDepartmentName.FromChar("");
+		budget.departmentCount = 0;
+		budget.loanCount = 0;
+	}
+
+	// Converts the names from older saves that use the Windows-1252 code page, this is
+	// done once when the name changes instead of every time the name is shown.
+	void ConvertToValidUtf8(cRZBaseString& text)
+	{
+		if (!Utf8Text::IsValid(text.ToChar(), text.Strlen()))
+		{
+			const std::string utf8 = Utf8Text::FromWindows1252(text.ToChar(), text.Strlen());
+
+			text.FromChar(utf8.c_str(), static_cast<uint32_t>(utf8.size()));
+		}
+	}
+
+	bool CountOccupantsIterator(cISC4Occupant*, void* pData)
+	{
+		++*static_cast<int32_t*>(pData);
+		return true;
+	}
 }
 
 CityStatusProvider::CityStatusProvider()
@@ -85,7 +144,21 @@ CityStatusProvider::CityStatusProvider()
 	  mayorRating(0),
 	  cityAgeInYears(0),
 	  monthlyNetIncome(0),
-	  totalFunds(0)
+	  totalFunds(0),
+	  averageAirPollution(0),
+	  averageWaterPollution(0),
+	  averagePoliceCoverage(0),
+	  averageAura(0),
+	  criminalCount(0),
+	  census(),
+	  lotCount(0),
+	  buildingCounter(),
+	  landmarkCount(0),
+	  budget(),
+	  pLotManager(nullptr),
+	  pCivicBuildingSim(nullptr),
+	  monthlyValuesUpdatedCallback(nullptr),
+	  monthlyValuesUpdatedContext(nullptr)
 {
 }
 
@@ -171,6 +244,56 @@ int64_t CityStatusProvider::GetTotalFunds() const
 	return totalFunds;
 }
 
+int32_t CityStatusProvider::GetAverageAirPollution() const
+{
+	return averageAirPollution;
+}
+
+int32_t CityStatusProvider::GetAverageWaterPollution() const
+{
+	return averageWaterPollution;
+}
+
+int32_t CityStatusProvider::GetAveragePoliceCoverage() const
+{
+	return averagePoliceCoverage;
+}
+
+int32_t CityStatusProvider::GetAverageAura() const
+{
+	return averageAura;
+}
+
+int32_t CityStatusProvider::GetCriminalCount() const
+{
+	return criminalCount;
+}
+
+int32_t CityStatusProvider::GetCensusValue(CensusType type) const
+{
+	return type < CensusType::Count ? census[ToIndex(type)] : 0;
+}
+
+int32_t CityStatusProvider::GetLotCount() const
+{
+	return lotCount;
+}
+
+int32_t CityStatusProvider::GetBuildingCount() const
+{
+	return buildingCounter.GetCount();
+}
+
+int32_t CityStatusProvider::GetLandmarkCount() const
+{
+	return landmarkCount;
+}
+
+const CityStatusProvider::BudgetSnapshot& CityStatusProvider::GetBudgetSnapshot() const
+{
+	return budget;
+}
+
 void CityStatusProvider::SetupCityStatusData(cISC4City* pCity)
 {
 	mayorName.FromChar("");
@@ -181,21 +304,33 @@ void CityStatusProvider::SetupCityStatusData(cISC4City* pCity)
 	cityAgeInYears = 0;
 	monthlyNetIncome = 0;
 	totalFunds = 0;
+	averageAirPollution = 0;
+	averageWaterPollution = 0;
+	averagePoliceCoverage = 0;
+	averageAura = 0;
+	criminalCount = 0;
+	census.fill(0);
+	lotCount = 0;
+	buildingCounter = BuildingCounter();
+	landmarkCount = 0;
+	ResetBudgetSnapshot(budget);
+	pLotManager = nullptr;
+	pCivicBuildingSim = nullptr;
 
 	if (pCity)
 	{
 		pCity->GetMayorName(mayorName);
+		ConvertToValidUtf8(mayorName);
 
-		cISC4DemandSimulator* pDemandSim = pCity->GetDemandSimulator();
 		cISC4ResidentialSimulator* pResidentialSim = pCity->GetResidentialSimulator();
 
-		if (pDemandSim && pResidentialSim)
+		if (pResidentialSim)
 		{
 			residentialPopulation = pResidentialSim->GetPopulation();
-			commercialPopulation = GetTotalJobsBySensus(*pDemandSim, CommercialDemandIds);
-			industrialPopulation = GetTotalJobsBySensus(*pDemandSim, IndustrialDemandIds);
 		}
 
+		RefreshCensus(pCity);
+
 		cISC4AuraSimulator* pAuraSim = pCity->GetAuraSimulator();
 
 		if (pAuraSim)
@@ -220,9 +355,19 @@ void CityStatusProvider::SetupCityStatusData(cISC4City* pCity)
 			totalFunds = pBudgetSim->GetTotalFunds();
 			monthlyNetIncome = pBudgetSim->GetTotalMonthlyIncome() - pBudgetSim->GetTotalMonthlyExpense();
 		}
+
+		RefreshBudgetSnapshot(pCity);
+		UpdateEnvironmentStats(pCity);
+		SeedOccupantCounters(pCity);
 	}
 }
 
+void CityStatusProvider::SetMonthlyValuesUpdatedCallback(MonthlyValuesUpdatedCallback callback, void* pContext)
+{
+	monthlyValuesUpdatedCallback = callback;
+	monthlyValuesUpdatedContext = pContext;
+}
+
 bool CityStatusProvider::QueryInterface(uint32_t riid, void** ppvObj)
 {
 	if (riid == GZCLSID::kcIGZMessageTarget2)
@@ -270,6 +415,15 @@ bool CityStatusProvider::DoMessage(cIGZMessage2* pMsg)
 	case kSC4MessageHistoryWarehouseRecordChanged:
 		HistoryWarehouseRecordChanged(pStandardMsg);
 		break;
+	case kSC4MessageInsertOccupant:
+		OccupantInserted(pStandardMsg);
+		break;
+	case kSC4MessageRemoveOccupant:
+		OccupantRemoved(pStandardMsg);
+		break;
+	case kSC4MessagePreCityShutdown:
+		PreCityShutdown();
+		break;
 	case kSC4MessageMayorNameChanged:
 		UpdateMayorName(pStandardMsg);
 		break;
@@ -310,6 +464,71 @@ void CityStatusProvider::HistoryWarehouseRecordChanged(cIGZMessage2Standard* pSt
 	}
 }
 
+void CityStatusProvider::OccupantInserted(cIGZMessage2Standard* pStandardMsg)
+{
+	cISC4Occupant* pOccupant = static_cast<cISC4Occupant*>(pStandardMsg->GetVoid1());
+
+	if (pOccupant && buildingCounter.OccupantInserted(static_cast<uint32_t>(pOccupant->GetType())))
+	{
+		UpdateLotAndLandmarkCounts();
+	}
+}
+
+void CityStatusProvider::OccupantRemoved(cIGZMessage2Standard* pStandardMsg)
+{
+	cISC4Occupant* pOccupant = static_cast<cISC4Occupant*>(pStandardMsg->GetVoid1());
+
+	if (pOccupant && buildingCounter.OccupantRemoved(static_cast<uint32_t>(pOccupant->GetType())))
+	{
+		UpdateLotAndLandmarkCounts();
+	}
+}
+
+void CityStatusProvider::PreCityShutdown()
+{
+	// Stop tracking before the game removes the city's occupants.
+	buildingCounter.Stop();
+	pLotManager = nullptr;
+	pCivicBuildingSim = nullptr;
+}
+
+void CityStatusProvider::SeedOccupantCounters(cISC4City* pCity)
+{
+	pLotManager = pCity->GetLotManager();
+	pCivicBuildingSim = pCity->GetCivicBuildingSimulator();
+
+	UpdateLotAndLandmarkCounts();
+
+	int32_t count = 0;
+	cISC4OccupantManager* pOccupantManager = pCity->GetOccupantManager();
+
+	if (pOccupantManager)
+	{
+		// This is the only full occupant scan, after this the building count
+		// is updated from the occupant insert and remove messages.
+		cSC4OccupantTypeFilter filter;
+		filter.AddOccupantType(BuildingCounter::BuildingOccupantType);
+
+		pOccupantManager->IterateOccupants(CountOccupantsIterator, &count, nullptr, nullptr, &filter);
+	}
+
+	buildingCounter.Start(count);
+}
+
+void CityStatusProvider::UpdateLotAndLandmarkCounts()
+{
+	// Both values are stored counters in the game, reading them does not scan the city.
+	if (pLotManager)
+	{
+		lotCount = pLotManager->GetLotCount();
+	}
+
+	if (pCivicBuildingSim)
+	{
+		landmarkCount = static_cast<int32_t>(pCivicBuildingSim->GetLandmarkCount());
+	}
+}
+
 void CityStatusProvider::SimNewMonth()
 {
 	cISC4AppPtr pSC4App;
@@ -326,6 +545,107 @@ void CityStatusProvider::SimNewMonth()
 			{
 				monthlyNetIncome = pBudgetSim->GetTotalMonthlyIncome() - pBudgetSim->GetTotalMonthlyExpense();
 			}
+
+			// The census, budget and grid statistics are only recomputed once per month.
+			RefreshCensus(pCity);
+
+			// Zoning or de-zoning an empty lot does not send an occupant message,
+			// so the stored lot and landmark counters are also re-read each month.
+			UpdateLotAndLandmarkCounts();
+
+			RefreshBudgetSnapshot(pCity);
+			UpdateEnvironmentStats(pCity);
+
+			if (monthlyValuesUpdatedCallback)
+			{
+				monthlyValuesUpdatedCallback(monthlyValuesUpdatedContext);
+			}
+		}
+	}
+}
+
+void CityStatusProvider::RefreshCensus(cISC4City* pCity)
+{
+	cISC4DemandSimulator* pDemandSim = pCity->GetDemandSimulator();
+
+	if (pDemandSim)
+	{
+		for (size_t i = 0; i < CensusDemandIds.size(); i++)
+		{
+			census[i] = static_cast<int32_t>(pDemandSim->GetJobsBySensus(CensusDemandIds[i]));
+		}
+
+		commercialPopulation = SumCensusRange(
+			census,
+			CensusType::CommercialServicesLowWealth,
+			CensusType::CommercialOfficeHighWealth);
+		industrialPopulation = SumCensusRange(
+			census,
+			CensusType::IndustrialAgriculture,
+			CensusType::IndustrialHighTech);
+	}
+}
+
+void CityStatusProvider::RefreshBudgetSnapshot(cISC4City* pCity)
+{
+	ResetBudgetSnapshot(budget);
+
+	cISC4BudgetSimulator* pBudgetSim = pCity->GetBudgetSimulator();
+
+	if (pBudgetSim)
+	{
+		budget.yearToDateIncome = pBudgetSim->GetYTDIncome();
+		budget.yearToDateExpenses = pBudgetSim->GetYTDExpenses();
+		budget.estimatedIncome = pBudgetSim->GetEstIncome();
+		budget.estimatedExpenses = pBudgetSim->GetEstExpenses();
+		budget.totalBorrowed = pBudgetSim->GetTotalBorrowed();
+		budget.monthlyLoanPayments = pBudgetSim->GetTotalMonthlyBondPayments();
+
+		// The vectors are filled by the game, so they must use the default allocator.
+		eastl::vector<cISC4BudgetSimulator::LoanInfo> loans;
+
+		if (pBudgetSim->GetAllLoans(loans))
+		{
+			budget.loanCount = static_cast<int32_t>(loans.size());
+		}
+
+		eastl::vector<cISC4BudgetSimulator::BudgetGroupInfo> groups;
+
+		if (pBudgetSim->GetAllGroups(groups))
+		{
+			eastl::vector<cISC4DepartmentBudget*> departments;
+			cISC4DepartmentBudget* pLargestExpenseDepartment = nullptr;
+
+			for (const cISC4BudgetSimulator::BudgetGroupInfo& group : groups)
+			{
+				departments.clear();
+
+				if (pBudgetSim->GetDepartmentBudgetsInGroup(static_cast<uint32_t>(group.groupID), departments))
+				{
+					for (cISC4DepartmentBudget* pDepartment : departments)
+					{
+						if (pDepartment)
+						{
+							budget.departmentCount++;
+
+							const int64_t expenses = pDepartment->GetTotalExpenses();
+
+							if (expenses > budget.largestDepartmentExpense)
+							{
+								budget.largestDepartmentExpense = expenses;
+								pLargestExpenseDepartment = pDepartment;
+							}
+						}
+					}
+				}
+			}
+
+			// Only the name of the winning department is copied.
+			if (pLargestExpenseDepartment)
+			{
+				pLargestExpenseDepartment->GetDepartmentName(budget.largestExpenseDepartmentName);
+				ConvertToValidUtf8(budget.largestExpenseDepartmentName);
+			}
 		}
 	}
 }
@@ -339,6 +659,8 @@ void CityStatusProvider::SimNewYear(cIGZMessage2Standard* pStandardMsg)
 
 void CityStatusProvider::UpdateCityFunds(cIGZMessage2Standard* pStandardMsg)
 {
+	// This message is sent for almost every transaction, the budget snapshot
+	// is intentionally not updated here.
 	cISC4BudgetSimulator* pBudgetSim = static_cast<cISC4BudgetSimulator*>(pStandardMsg->GetVoid1());
 
 	if (pBudgetSim)
@@ -347,6 +669,35 @@ void CityStatusProvider::UpdateCityFunds(cIGZMessage2Standard* pStandardMsg)
 	}
 }
 
+void CityStatusProvider::UpdateEnvironmentStats(cISC4City* pCity)
+{
+	cISC4PollutionSimulator* pPollutionSim = pCity->GetPollutionSimulator();
+
+	if (pPollutionSim)
+	{
+		GridStatistics::GetAverageTractValue(pPollutionSim->GetPollutionGrid(kAirPollution), averageAirPollution);
+		GridStatistics::GetAverageTractValue(pPollutionSim->GetPollutionGrid(kWaterPollution), averageWaterPollution);
+	}
+
+	cISC4PoliceSimulator* pPoliceSim = pCity->GetPoliceSimulator();
+
+	if (pPoliceSim)
+	{
+		GridStatistics::GetAverageTractValue(pPoliceSim->GetPolicePowerGrid(), averagePoliceCoverage);
+
+		// The police power grid is the coverage of the police stations, the
+		// number of criminals is the simulator's own crime count.
+		criminalCount = static_cast<int32_t>(pPoliceSim->GetCriminalCount());
+	}
+
+	cISC4AuraSimulator* pAuraSim = pCity->GetAuraSimulator();
+
+	if (pAuraSim)
+	{
+		GridStatistics::GetAverageTractValue(pAuraSim->GetAuraGrid(), averageAura);
+	}
+}
+
 void CityStatusProvider::UpdateMayorName(cIGZMessage2Standard* pStandardMsg)
 {
 	cISC4City* pCity = static_cast<cISC4City*>(pStandardMsg->GetVoid1());
@@ -354,5 +705,6 @@ void CityStatusProvider::UpdateMayorName(cIGZMessage2Standard* pStandardMsg)
 	if (pCity)
 	{
 		pCity->GetMayorName(mayorName);
+		ConvertToValidUtf8(mayorName);
 	}
 }
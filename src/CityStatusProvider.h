@@ -11,17 +11,55 @@
 ////////////////////////////////////////////////////////////////////////
 
 #pragma once
+#include "BuildingCounter.h"
 #include "cIGZMessageTarget2.h"
 #include "cRZBaseString.h"
+#include <array>
 #include <cstdint>
 #include <string>
 
 class cIGZMessage2Standard;
 class cISC4City;
+class cISC4CivicBuildingSimulator;
+class cISC4LotManager;
 
 class CityStatusProvider : private cIGZMessageTarget2
 {
 public:
+	enum class CensusType : uint32_t
+	{
+		ResidentialLowWealth = 0,
+		ResidentialMediumWealth,
+		ResidentialHighWealth,
+		CommercialServicesLowWealth,
+		CommercialServicesMediumWealth,
+		CommercialServicesHighWealth,
+		CommercialOfficeMediumWealth,
+		CommercialOfficeHighWealth,
+		IndustrialAgriculture,
+		IndustrialDirty,
+		IndustrialManufacturing,
+		IndustrialHighTech,
+		Count
+	};
+
+	// The budget values that are refreshed once per simulation month.
+	struct BudgetSnapshot
+	{
+		int64_t yearToDateIncome;
+		int64_t yearToDateExpenses;
+		int64_t estimatedIncome;
+		int64_t estimatedExpenses;
+		int64_t totalBorrowed;
+		int64_t monthlyLoanPayments;
+		int64_t largestDepartmentExpense;
+		cRZBaseString largestExpenseDepartmentName;
+		int32_t departmentCount;
+		int32_t loanCount;
+	};
+
+	typedef void (*MonthlyValuesUpdatedCallback)(void* pContext);
+
 	CityStatusProvider();
 
 	bool Init();
@@ -36,9 +74,23 @@ public:
 	int32_t GetCityAgeInYears() const;
 	int32_t GetMonthlyNetIncome() const;
 	int64_t GetTotalFunds() const;
+	int32_t GetAverageAirPollution() const;
+	int32_t GetAverageWaterPollution() const;
+	int32_t GetAveragePoliceCoverage() const;
+	int32_t GetAverageAura() const;
+	int32_t GetCriminalCount() const;
+	int32_t GetCensusValue(CensusType type) const;
+	int32_t GetLotCount() const;
+	int32_t GetBuildingCount() const;
+	int32_t GetLandmarkCount() const;
+	const BudgetSnapshot& GetBudgetSnapshot() const;
 
 	void SetupCityStatusData(cISC4City*);
 
+	// Sets the function that is called after the values that are refreshed once per
+	// simulation month have been updated.
+	void SetMonthlyValuesUpdatedCallback(MonthlyValuesUpdatedCallback callback, void* pContext);
+
 private:
 	bool QueryInterface(uint32_t riid, void** ppvObj);
 	uint32_t AddRef();
@@ -47,9 +99,17 @@ private:
 	bool DoMessage(cIGZMessage2*);
 
 	void HistoryWarehouseRecordChanged(cIGZMessage2Standard*);
+	void OccupantInserted(cIGZMessage2Standard*);
+	void OccupantRemoved(cIGZMessage2Standard*);
+	void PreCityShutdown();
+	void SeedOccupantCounters(cISC4City*);
+	void UpdateLotAndLandmarkCounts();
 	void SimNewMonth();
 	void SimNewYear(cIGZMessage2Standard*);
+	void RefreshCensus(cISC4City*);
+	void RefreshBudgetSnapshot(cISC4City*);
 	void UpdateCityFunds(cIGZMessage2Standard*);
+	void UpdateEnvironmentStats(cISC4City*);
 	void UpdateMayorName(cIGZMessage2Standard*);
 
 	uint32_t refCount;
@@ -61,5 +121,19 @@ private:
 	int32_t cityAgeInYears;
 	int32_t monthlyNetIncome;
 	int64_t totalFunds;
+	int32_t averageAirPollution;
+	int32_t averageWaterPollution;
+	int32_t averagePoliceCoverage;
+	int32_t averageAura;
+	int32_t criminalCount;
+	std::array<int32_t, static_cast<size_t>(CensusType::Count)> census;
+	int32_t lotCount;
+	BuildingCounter buildingCounter;
+	int32_t landmarkCount;
+	BudgetSnapshot budget;
+	cISC4LotManager* pLotManager;
+	cISC4CivicBuildingSimulator* pCivicBuildingSim;
+	MonthlyValuesUpdatedCallback monthlyValuesUpdatedCallback;
+	void* monthlyValuesUpdatedContext;
 };
 
@@ -0,0 +1,96 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-discord-rich-presence, a DLL Plugin for
+// SimCity 4 that implements Discord rich presence support.
+//
+// Copyright (c) 2024 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include "Utf8Text.h"
+#include <cstdint>
+#include <cstring>
+
+// The rich presence activity that is sent to Discord.
+// The strings use fixed size buffers, matching the limits that Discord enforces
+// for the activity fields.
+class DiscordActivity
+{
+public:
+	static constexpr size_t MaxStringLength = 128;
+
+	DiscordActivity()
+		: state{},
+		  details{},
+		  largeImage{},
+		  startTimestamp(0)
+	{
+	}
+
+	const char* GetState() const
+	{
+		return state;
+	}
+
+	void SetState(const char* value)
+	{
+		CopyString(state, value);
+	}
+
+	const char* GetDetails() const
+	{
+		return details;
+	}
+
+	void SetDetails(const char* value)
+	{
+		CopyString(details, value);
+	}
+
+	const char* GetLargeImage() const
+	{
+		return largeImage;
+	}
+
+	void SetLargeImage(const char* value)
+	{
+		CopyString(largeImage, value);
+	}
+
+	// The Unix time at which the activity started, or 0 if the elapsed time is not shown.
+	int64_t GetStartTimestamp() const
+	{
+		return startTimestamp;
+	}
+
+	void SetStartTimestamp(int64_t value)
+	{
+		startTimestamp = value;
+	}
+
+private:
+	static void CopyString(char (&destination)[MaxStringLength], const char* value)
+	{
+		if (value)
+		{
+			// Long strings are truncated at a UTF-8 character boundary.
+			const size_t length = Utf8Text::FindTruncationPoint(value, std::strlen(value), MaxStringLength - 1);
+
+			std::memcpy(destination, value, length);
+			destination[length] = '\0';
+		}
+		else
+		{
+			destination[0] = '\0';
+		}
+	}
+
+	char state[MaxStringLength];
+	char details[MaxStringLength];
+	char largeImage[MaxStringLength];
+	int64_t startTimestamp;
+};
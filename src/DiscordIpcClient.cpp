@@ -0,0 +1,542 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-discord-rich-presence, a DLL Plugin for
+// SimCity 4 that implements Discord rich presence support.
+//
+// Copyright (c) 2024 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#include "DiscordIpcClient.h"
+#include "DiscordJsonWriter.h"
+#include "Logger.h"
+#include <charconv>
+#include <cstring>
+#include <cwchar>
+#include <string_view>
+#include <Windows.h>
+
+using namespace std::string_view_literals;
+
+namespace
+{
+	// Discord uses the first available pipe from discord-ipc-0 to discord-ipc-9.
+	constexpr int MaxPipeIndex = 9;
+
+	// The interval between connection attempts when Discord is not running.
+	constexpr std::chrono::seconds ReconnectInterval(15);
+
+	// The time after which a request that Discord has not responded to is considered lost.
+	constexpr std::chrono::seconds RequestTimeout(10);
+
+	bool TryGetNonce(std::string_view json, uint64_t& nonce)
+	{
+		constexpr std::string_view NonceKey = "\"nonce\":\""sv;
+
+		const size_t keyOffset = json.find(NonceKey);
+
+		if (keyOffset != std::string_view::npos)
+		{
+			const char* first = json.data() + keyOffset + NonceKey.size();
+			const char* last = json.data() + json.size();
+
+			return std::from_chars(first, last, nonce).ec == std::errc{} && nonce != 0;
+		}
+
+		return false;
+	}
+
+	HANDLE ToHandle(void* pipe)
+	{
+		return static_cast<HANDLE>(pipe);
+	}
+
+	bool ReadExact(HANDLE pipe, void* buffer, DWORD size)
+	{
+		uint8_t* destination = static_cast<uint8_t*>(buffer);
+		DWORD totalRead = 0;
+
+		while (totalRead < size)
+		{
+			DWORD bytesRead = 0;
+
+			if (!ReadFile(pipe, destination + totalRead, size - totalRead, &bytesRead, nullptr) || bytesRead == 0)
+			{
+				return false;
+			}
+
+			totalRead += bytesRead;
+		}
+
+		return true;
+	}
+
+	void WriteActivity(DiscordJsonWriter& writer, const DiscordActivity& activity)
+	{
+		writer.BeginObject("activity");
+
+		// Discord rejects empty strings, so the fields that are not set are omitted.
+		if (activity.GetDetails()[0] != '\0')
+		{
+			writer.String("details", activity.GetDetails());
+		}
+
+		if (activity.GetState()[0] != '\0')
+		{
+			writer.String("state", activity.GetState());
+		}
+
+		if (activity.GetStartTimestamp() != 0)
+		{
+			writer.BeginObject("timestamps");
+			writer.Int64("start", activity.GetStartTimestamp());
+			writer.EndObject();
+		}
+
+		if (activity.GetLargeImage()[0] != '\0')
+		{
+			writer.BeginObject("assets");
+			writer.String("large_image", activity.GetLargeImage());
+			writer.EndObject();
+		}
+
+		writer.EndObject();
+	}
+}
+
+DiscordIpcClient::DiscordIpcClient(int64_t applicationId, const PresenceClock& clock)
+	: applicationId(applicationId),
+	  clock(clock),
+	  processId(GetCurrentProcessId()),
+	  pipe(INVALID_HANDLE_VALUE),
+	  state(State::Disconnected),
+	  nextNonce(1),
+	  nextConnectTime(),
+	  pendingRequests{},
+	  requestStats(),
+	  requestCompletedCallback(nullptr),
+	  requestCompletedContext(nullptr),
+	  writeBuffer{},
+	  readBuffer{},
+	  currentFrameHeader{},
+	  currentFrameBytesRead(0),
+	  readingFramePayload(false)
+{
+}
+
+DiscordIpcClient::~DiscordIpcClient()
+{
+	// The callback owner may already be partially destroyed.
+	requestCompletedCallback = nullptr;
+	Disconnect();
+}
+
+bool DiscordIpcClient::Poll()
+{
+	bool becameReady = false;
+
+	if (state == State::Disconnected)
+	{
+		const auto now = clock.GetSteadyTime();
+
+		if (now >= nextConnectTime)
+		{
+			nextConnectTime = now + ReconnectInterval;
+
+			if (!Connect())
+			{
+				return false;
+			}
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+	if (!ReadFrames(becameReady))
+	{
+		Disconnect();
+		becameReady = false;
+	}
+	else
+	{
+		ExpirePendingRequests(clock.GetSteadyTime());
+	}
+
+	return becameReady;
+}
+
+bool DiscordIpcClient::IsReady() const
+{
+	return state == State::Ready;
+}
+
+void DiscordIpcClient::SetRequestCompletedCallback(RequestCompletedCallback callback, void* pContext)
+{
+	requestCompletedCallback = callback;
+	requestCompletedContext = pContext;
+}
+
+uint64_t DiscordIpcClient::UpdateActivity(const DiscordActivity& activity)
+{
+	return SendSetActivity(&activity);
+}
+
+uint64_t DiscordIpcClient::ClearActivity()
+{
+	return SendSetActivity(nullptr);
+}
+
+void DiscordIpcClient::Disconnect()
+{
+	AbandonPendingRequests();
+
+	if (pipe != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(ToHandle(pipe));
+		pipe = INVALID_HANDLE_VALUE;
+
+		if (state == State::Ready)
+		{
+			LOG_INFO("Disconnected from Discord.");
+		}
+	}
+
+	state = State::Disconnected;
+	readingFramePayload = false;
+}
+
+const DiscordRequestStats& DiscordIpcClient::GetRequestStats() const
+{
+	return requestStats;
+}
+
+bool DiscordIpcClient::Connect()
+{
+	for (int i = 0; i <= MaxPipeIndex; i++)
+	{
+		wchar_t pipeName[32]{};
+		std::swprintf(pipeName, std::size(pipeName), L"\\\\.\\pipe\\discord-ipc-%d", i);
+
+		HANDLE handle = CreateFileW(pipeName, GENERIC_READ | GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, 0, nullptr);
+
+		if (handle != INVALID_HANDLE_VALUE)
+		{
+			pipe = handle;
+			break;
+		}
+	}
+
+	if (pipe == INVALID_HANDLE_VALUE)
+	{
+		// Discord is not running.
+		return false;
+	}
+
+	char clientId[24]{};
+	std::to_chars(clientId, clientId + sizeof(clientId) - 1, applicationId);
+
+	DiscordJsonWriter writer(writeBuffer.data() + FrameHeaderSize, writeBuffer.size() - FrameHeaderSize);
+	writer.BeginObject();
+	writer.Int64("v", 1);
+	writer.String("client_id", clientId);
+	writer.EndObject();
+
+	if (writer.Failed() || !SendFrame(Opcode::Handshake, writer.GetLength()))
+	{
+		Disconnect();
+		return false;
+	}
+
+	state = State::WaitingForReady;
+	return true;
+}
+
+bool DiscordIpcClient::ReadFrames(bool& becameReady)
+{
+	HANDLE handle = ToHandle(pipe);
+
+	while (true)
+	{
+		DWORD bytesAvailable = 0;
+
+		if (!PeekNamedPipe(handle, nullptr, 0, nullptr, &bytesAvailable, nullptr))
+		{
+			return false;
+		}
+
+		// Only the bytes that are already in the pipe are read, ReadFile would block
+		// the game's main thread until the rest of a partially written frame arrives.
+		if (!readingFramePayload)
+		{
+			if (bytesAvailable < FrameHeaderSize)
+			{
+				return true;
+			}
+
+			if (!ReadExact(handle, &currentFrameHeader, static_cast<DWORD>(FrameHeaderSize)))
+			{
+				return false;
+			}
+
+			bytesAvailable -= static_cast<DWORD>(FrameHeaderSize);
+			currentFrameBytesRead = 0;
+			readingFramePayload = true;
+		}
+
+		// The READY event contains the user object, it is the largest message that we
+		// expect to receive. Any part of a frame that does not fit in the buffer is discarded.
+		const size_t payloadLength = currentFrameHeader.length;
+		const size_t bufferedLength = payloadLength < readBuffer.size() ? payloadLength : readBuffer.size();
+
+		while (currentFrameBytesRead < payloadLength)
+		{
+			if (bytesAvailable == 0)
+			{
+				return true;
+			}
+
+			char discard[256];
+			char* destination = discard;
+			size_t chunkSize = payloadLength - currentFrameBytesRead;
+
+			if (currentFrameBytesRead < bufferedLength)
+			{
+				destination = readBuffer.data() + currentFrameBytesRead;
+				chunkSize = bufferedLength - currentFrameBytesRead;
+			}
+			else if (chunkSize > sizeof(discard))
+			{
+				chunkSize = sizeof(discard);
+			}
+
+			if (chunkSize > bytesAvailable)
+			{
+				chunkSize = bytesAvailable;
+			}
+
+			if (!ReadExact(handle, destination, static_cast<DWORD>(chunkSize)))
+			{
+				return false;
+			}
+
+			currentFrameBytesRead += chunkSize;
+			bytesAvailable -= static_cast<DWORD>(chunkSize);
+		}
+
+		readingFramePayload = false;
+
+		if (!HandleFrame(static_cast<Opcode>(currentFrameHeader.opcode), readBuffer.data(), bufferedLength, becameReady))
+		{
+			return false;
+		}
+	}
+}
+
+bool DiscordIpcClient::HandleFrame(Opcode opcode, const char* payload, size_t length, bool& becameReady)
+{
+	const std::string_view json(payload, length);
+
+	switch (opcode)
+	{
+	case Opcode::Frame:
+	{
+		const bool isError = json.find("\"evt\":\"ERROR\""sv) != std::string_view::npos;
+		uint64_t nonce = 0;
+
+		if (TryGetNonce(json, nonce))
+		{
+			// The response to one of our commands.
+			if (isError)
+			{
+				LOG_ERROR("Discord request {} failed: {}", nonce, json);
+			}
+
+			CompleteRequest(nonce, isError ? DiscordRequestResult::DiscordError : DiscordRequestResult::Ok);
+		}
+		else if (json.find("\"evt\":\"READY\""sv) != std::string_view::npos)
+		{
+			if (state == State::WaitingForReady)
+			{
+				state = State::Ready;
+				becameReady = true;
+
+				LOG_INFO("Connected to Discord.");
+			}
+		}
+		else if (isError)
+		{
+			LOG_ERROR("Discord returned an error: {}", json);
+		}
+		return true;
+	}
+	case Opcode::Ping:
+		if (length <= (writeBuffer.size() - FrameHeaderSize))
+		{
+			std::memcpy(writeBuffer.data() + FrameHeaderSize, payload, length);
+			return SendFrame(Opcode::Pong, length);
+		}
+		return true;
+	case Opcode::Close:
+		LOG_ERROR("Discord closed the connection: {}", json);
+		return false;
+	case Opcode::Handshake:
+	case Opcode::Pong:
+	default:
+		return true;
+	}
+}
+
+uint64_t DiscordIpcClient::SendSetActivity(const DiscordActivity* pActivity)
+{
+	if (state != State::Ready)
+	{
+		return 0;
+	}
+
+	// The nonce is used as the request id, Discord includes it in the response.
+	const uint64_t requestId = nextNonce++;
+
+	char nonce[24]{};
+	std::to_chars(nonce, nonce + sizeof(nonce) - 1, requestId);
+
+	DiscordJsonWriter writer(writeBuffer.data() + FrameHeaderSize, writeBuffer.size() - FrameHeaderSize);
+	writer.BeginObject();
+	writer.String("cmd", "SET_ACTIVITY");
+	writer.BeginObject("args");
+	writer.Int64("pid", processId);
+
+	if (pActivity)
+	{
+		WriteActivity(writer, *pActivity);
+	}
+	else
+	{
+		writer.Null("activity");
+	}
+
+	writer.EndObject();
+	writer.String("nonce", nonce);
+	writer.EndObject();
+
+	if (writer.Failed())
+	{
+		LOG_ERROR("The Discord activity is too large.");
+		requestStats.RecordResult(DiscordRequestResult::SendFailed, {});
+		return 0;
+	}
+
+	if (!SendFrame(Opcode::Frame, writer.GetLength()))
+	{
+		LOG_ERROR("Failed to send Discord request {}.", requestId);
+		requestStats.RecordResult(DiscordRequestResult::SendFailed, {});
+		Disconnect();
+		return 0;
+	}
+
+	AddPendingRequest(requestId, clock.GetSteadyTime());
+
+	return requestId;
+}
+
+bool DiscordIpcClient::SendFrame(Opcode opcode, size_t payloadLength)
+{
+	// The payload has already been written after the space reserved for the header.
+	const FrameHeader header{ static_cast<uint32_t>(opcode), static_cast<uint32_t>(payloadLength) };
+	std::memcpy(writeBuffer.data(), &header, FrameHeaderSize);
+
+	const DWORD frameSize = static_cast<DWORD>(FrameHeaderSize + payloadLength);
+	DWORD bytesWritten = 0;
+
+	return WriteFile(ToHandle(pipe), writeBuffer.data(), frameSize, &bytesWritten, nullptr)
+		&& bytesWritten == frameSize;
+}
+
+void DiscordIpcClient::AddPendingRequest(uint64_t id, std::chrono::steady_clock::time_point now)
+{
+	PendingRequest* pSlot = nullptr;
+
+	for (PendingRequest& request : pendingRequests)
+	{
+		if (request.id == 0)
+		{
+			pSlot = &request;
+			break;
+		}
+
+		if (!pSlot || request.sendTime < pSlot->sendTime)
+		{
+			pSlot = &request;
+		}
+	}
+
+	// When all of the entries are in use the oldest request is treated as lost.
+	if (pSlot->id != 0)
+	{
+		CompleteRequest(*pSlot, DiscordRequestResult::TimedOut, now);
+	}
+
+	pSlot->id = id;
+	pSlot->sendTime = now;
+}
+
+void DiscordIpcClient::CompleteRequest(PendingRequest& request, DiscordRequestResult result, std::chrono::steady_clock::time_point now)
+{
+	const uint64_t id = request.id;
+	const std::chrono::steady_clock::duration latency = now - request.sendTime;
+
+	request.id = 0;
+	requestStats.RecordResult(result, latency);
+
+	LOG_DEBUG(
+		"Discord request {}: {} after {} ms",
+		id,
+		GetDiscordRequestResultName(result),
+		std::chrono::duration_cast<std::chrono::milliseconds>(latency).count());
+
+	if (requestCompletedCallback)
+	{
+		requestCompletedCallback(requestCompletedContext, id, result);
+	}
+}
+
+void DiscordIpcClient::CompleteRequest(uint64_t id, DiscordRequestResult result)
+{
+	for (PendingRequest& request : pendingRequests)
+	{
+		if (request.id == id)
+		{
+			CompleteRequest(request, result, clock.GetSteadyTime());
+			break;
+		}
+	}
+}
+
+void DiscordIpcClient::ExpirePendingRequests(std::chrono::steady_clock::time_point now)
+{
+	for (PendingRequest& request : pendingRequests)
+	{
+		if (request.id != 0 && (now - request.sendTime) >= RequestTimeout)
+		{
+			LOG_ERROR("Discord did not respond to request {}.", request.id);
+			CompleteRequest(request, DiscordRequestResult::TimedOut, now);
+		}
+	}
+}
+
+void DiscordIpcClient::AbandonPendingRequests()
+{
+	const auto now = clock.GetSteadyTime();
+
+	for (PendingRequest& request : pendingRequests)
+	{
+		if (request.id != 0)
+		{
+			CompleteRequest(request, DiscordRequestResult::Disconnected, now);
+		}
+	}
+}
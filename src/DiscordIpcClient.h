@@ -0,0 +1,122 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-discord-rich-presence, a DLL Plugin for
+// SimCity 4 that implements Discord rich presence support.
+//
+// Copyright (c) 2024 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include "DiscordActivity.h"
+#include "DiscordRequestStats.h"
+#include "IDiscordActivitySender.h"
+#include "PresenceClock.h"
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+// A client for the local Discord IPC protocol, this replaces the Discord Game SDK.
+//
+// Discord listens on the \\.\pipe\discord-ipc-N named pipes, each message is a frame
+// that consists of a 32-bit opcode and a 32-bit payload length followed by the
+// UTF-8 JSON payload.
+class DiscordIpcClient final : public IDiscordActivitySender
+{
+public:
+	typedef void (*RequestCompletedCallback)(void* pContext, uint64_t requestId, DiscordRequestResult result);
+
+	DiscordIpcClient(int64_t applicationId, const PresenceClock& clock);
+	~DiscordIpcClient();
+
+	DiscordIpcClient(const DiscordIpcClient&) = delete;
+	DiscordIpcClient& operator=(const DiscordIpcClient&) = delete;
+
+	// Reads the pending messages from Discord and reconnects if the connection was lost.
+	// Returns true if the connection became ready during this call, the caller should
+	// send its current activity when that happens.
+	bool Poll();
+
+	bool IsReady() const override;
+
+	// Sets the function that is called when Discord responds to a request, or the
+	// request times out or is abandoned because the connection was closed.
+	void SetRequestCompletedCallback(RequestCompletedCallback callback, void* pContext);
+
+	// The activity methods return the request id, or 0 if the request could not be sent.
+	uint64_t UpdateActivity(const DiscordActivity& activity) override;
+
+	uint64_t ClearActivity();
+
+	void Disconnect();
+
+	const DiscordRequestStats& GetRequestStats() const;
+
+private:
+	enum class Opcode : uint32_t
+	{
+		Handshake = 0,
+		Frame = 1,
+		Close = 2,
+		Ping = 3,
+		Pong = 4
+	};
+
+	enum class State
+	{
+		Disconnected,
+		WaitingForReady,
+		Ready
+	};
+
+	struct FrameHeader
+	{
+		uint32_t opcode;
+		uint32_t length;
+	};
+
+	struct PendingRequest
+	{
+		uint64_t id;
+		std::chrono::steady_clock::time_point sendTime;
+	};
+
+	bool Connect();
+	bool ReadFrames(bool& becameReady);
+	bool HandleFrame(Opcode opcode, const char* payload, size_t length, bool& becameReady);
+	uint64_t SendSetActivity(const DiscordActivity* pActivity);
+	bool SendFrame(Opcode opcode, size_t payloadLength);
+	void AddPendingRequest(uint64_t id, std::chrono::steady_clock::time_point now);
+	void CompleteRequest(PendingRequest& request, DiscordRequestResult result, std::chrono::steady_clock::time_point now);
+	void CompleteRequest(uint64_t id, DiscordRequestResult result);
+	void ExpirePendingRequests(std::chrono::steady_clock::time_point now);
+	void AbandonPendingRequests();
+
+	static constexpr size_t FrameHeaderSize = sizeof(FrameHeader);
+	static constexpr size_t MaxPendingRequests = 8;
+
+	const int64_t applicationId;
+	const PresenceClock& clock;
+	const uint32_t processId;
+	// The named pipe HANDLE, this is a void pointer to keep Windows.h out of the header.
+	void* pipe;
+	State state;
+	uint64_t nextNonce;
+	std::chrono::steady_clock::time_point nextConnectTime;
+	// A request id of 0 marks an unused entry.
+	std::array<PendingRequest, MaxPendingRequests> pendingRequests;
+	DiscordRequestStats requestStats;
+	RequestCompletedCallback requestCompletedCallback;
+	void* requestCompletedContext;
+	// The outgoing frame header and JSON payload are written directly into this buffer.
+	std::array<char, 4096> writeBuffer;
+	std::array<char, 8192> readBuffer;
+	// A frame can arrive in several parts, the frame that is being read is kept
+	// between the Poll calls so that a read never waits for data.
+	FrameHeader currentFrameHeader;
+	size_t currentFrameBytesRead;
+	bool readingFramePayload;
+};
@@ -0,0 +1,192 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-discord-rich-presence, a DLL Plugin for
+// SimCity 4 that implements Discord rich presence support.
+//
+// Copyright (c) 2024 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#include "DiscordJsonWriter.h"
+#include <charconv>
+#include <cstring>
+
+namespace
+{
+	constexpr uint32_t MaxDepth = 32;
+}
+
+DiscordJsonWriter::DiscordJsonWriter(char* buffer, size_t capacity)
+	: buffer(buffer),
+	  capacity(capacity),
+	  length(0),
+	  objectHasValueBits(0),
+	  depth(0),
+	  failed(buffer == nullptr || capacity == 0)
+{
+}
+
+void DiscordJsonWriter::BeginObject()
+{
+	WriteSeparator();
+	OpenObject();
+}
+
+void DiscordJsonWriter::BeginObject(const char* key)
+{
+	WriteKey(key);
+	OpenObject();
+}
+
+void DiscordJsonWriter::EndObject()
+{
+	if (depth > 0)
+	{
+		depth--;
+		WriteChar('}');
+	}
+	else
+	{
+		failed = true;
+	}
+}
+
+void DiscordJsonWriter::Null(const char* key)
+{
+	WriteKey(key);
+	WriteRaw("null", 4);
+}
+
+void DiscordJsonWriter::Int64(const char* key, int64_t value)
+{
+	WriteKey(key);
+
+	char digits[24];
+	const std::to_chars_result result = std::to_chars(digits, digits + sizeof(digits), value);
+
+	WriteRaw(digits, static_cast<size_t>(result.ptr - digits));
+}
+
+void DiscordJsonWriter::String(const char* key, const char* value)
+{
+	WriteKey(key);
+	WriteEscapedString(value ? value : "");
+}
+
+bool DiscordJsonWriter::Failed() const
+{
+	return failed;
+}
+
+size_t DiscordJsonWriter::GetLength() const
+{
+	return length;
+}
+
+void DiscordJsonWriter::OpenObject()
+{
+	WriteChar('{');
+
+	if (depth < MaxDepth)
+	{
+		depth++;
+		objectHasValueBits &= ~(1U << (depth - 1));
+	}
+	else
+	{
+		failed = true;
+	}
+}
+
+void DiscordJsonWriter::WriteKey(const char* key)
+{
+	WriteSeparator();
+	WriteEscapedString(key);
+	WriteChar(':');
+}
+
+void DiscordJsonWriter::WriteSeparator()
+{
+	if (depth > 0)
+	{
+		const uint32_t mask = 1U << (depth - 1);
+
+		if ((objectHasValueBits & mask) != 0)
+		{
+			WriteChar(',');
+		}
+		else
+		{
+			objectHasValueBits |= mask;
+		}
+	}
+}
+
+void DiscordJsonWriter::WriteEscapedString(const char* value)
+{
+	static constexpr char HexDigits[] = "0123456789abcdef";
+
+	WriteChar('"');
+
+	// The strings are UTF-8, only the quote, backslash and control characters need to be escaped.
+	for (const unsigned char* p = reinterpret_cast<const unsigned char*>(value); *p != 0; p++)
+	{
+		const unsigned char c = *p;
+
+		switch (c)
+		{
+		case '"':
+			WriteRaw("\\\"", 2);
+			break;
+		case '\\':
+			WriteRaw("\\\\", 2);
+			break;
+		case '\n':
+			WriteRaw("\\n", 2);
+			break;
+		case '\r':
+			WriteRaw("\\r", 2);
+			break;
+		case '\t':
+			WriteRaw("\\t", 2);
+			break;
+		default:
+			if (c < 0x20)
+			{
+				const char escape[6] = { '\\', 'u', '0', '0', HexDigits[c >> 4], HexDigits[c & 0xF] };
+				WriteRaw(escape, sizeof(escape));
+			}
+			else
+			{
+				WriteChar(static_cast<char>(c));
+			}
+			break;
+		}
+	}
+
+	WriteChar('"');
+}
+
+void DiscordJsonWriter::WriteRaw(const char* value, size_t count)
+{
+	if (!failed)
+	{
+		if (count <= (capacity - length))
+		{
+			std::memcpy(buffer + length, value, count);
+			length += count;
+		}
+		else
+		{
+			failed = true;
+		}
+	}
+}
+
+void DiscordJsonWriter::WriteChar(char value)
+{
+	WriteRaw(&value, 1);
+}
@@ -0,0 +1,54 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-discord-rich-presence, a DLL Plugin for
+// SimCity 4 that implements Discord rich presence support.
+//
+// Copyright (c) 2024 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// A minimal JSON writer that writes into a caller-provided buffer without allocating.
+// It only supports the value types that are used in the Discord IPC commands.
+//
+// If the output does not fit in the buffer the writer enters a failed state
+// and all further writes are ignored.
+class DiscordJsonWriter
+{
+public:
+	DiscordJsonWriter(char* buffer, size_t capacity);
+
+	void BeginObject();
+	void BeginObject(const char* key);
+	void EndObject();
+
+	void Null(const char* key);
+	void Int64(const char* key, int64_t value);
+	void String(const char* key, const char* value);
+
+	bool Failed() const;
+	size_t GetLength() const;
+
+private:
+	void OpenObject();
+	void WriteKey(const char* key);
+	void WriteSeparator();
+	void WriteEscapedString(const char* value);
+	void WriteRaw(const char* value, size_t length);
+	void WriteChar(char value);
+
+	char* const buffer;
+	const size_t capacity;
+	size_t length;
+	// Each bit records if the object at that nesting depth has a value,
+	// which determines if a comma is needed before the next key.
+	uint32_t objectHasValueBits;
+	uint32_t depth;
+	bool failed;
+};
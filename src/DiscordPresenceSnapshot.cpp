@@ -0,0 +1,148 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-discord-rich-presence, a DLL Plugin for
+// SimCity 4 that implements Discord rich presence support.
+//
+// Copyright (c) 2024 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#include "DiscordPresenceSnapshot.h"
+
+namespace
+{
+	// The public structs do not declare comparison operators, so that the header
+	// can be used by plugins that are built with an older C++ standard.
+	bool AreEqual(const DiscordPresenceCityStats& lhs, const DiscordPresenceCityStats& rhs)
+	{
+		return lhs.totalFunds == rhs.totalFunds
+			&& lhs.residentialPopulation == rhs.residentialPopulation
+			&& lhs.commercialPopulation == rhs.commercialPopulation
+			&& lhs.industrialPopulation == rhs.industrialPopulation
+			&& lhs.mayorRating == rhs.mayorRating
+			&& lhs.cityAgeInYears == rhs.cityAgeInYears
+			&& lhs.monthlyNetIncome == rhs.monthlyNetIncome
+			&& lhs.averageAirPollution == rhs.averageAirPollution
+			&& lhs.averageWaterPollution == rhs.averageWaterPollution
+			&& lhs.averagePoliceCoverage == rhs.averagePoliceCoverage
+			&& lhs.averageAura == rhs.averageAura
+			&& lhs.lotCount == rhs.lotCount
+			&& lhs.buildingCount == rhs.buildingCount
+			&& lhs.landmarkCount == rhs.landmarkCount
+			&& lhs.criminalCount == rhs.criminalCount;
+	}
+
+	bool AreEqual(const DiscordPresenceRegionStats& lhs, const DiscordPresenceRegionStats& rhs)
+	{
+		return lhs.totalResidentialPopulation == rhs.totalResidentialPopulation
+			&& lhs.totalCommercialJobs == rhs.totalCommercialJobs
+			&& lhs.totalIndustrialJobs == rhs.totalIndustrialJobs
+			&& lhs.totalFunds == rhs.totalFunds
+			&& lhs.developedCellCount == rhs.developedCellCount
+			&& lhs.totalCities == rhs.totalCities
+			&& lhs.developedCityCount == rhs.developedCityCount
+			&& lhs.undevelopedCityCount == rhs.undevelopedCityCount
+			&& lhs.borderingCityCount == rhs.borderingCityCount
+			&& lhs.standaloneCityCount == rhs.standaloneCityCount
+			&& lhs.developedLandPercentage == rhs.developedLandPercentage
+			&& lhs.cityClusterCount == rhs.cityClusterCount
+			&& lhs.largestCityClusterSize == rhs.largestCityClusterSize;
+	}
+}
+
+bool DiscordPresenceSnapshotData::operator==(const DiscordPresenceSnapshotData& other) const
+{
+	return view == other.view
+		&& cityName == other.cityName
+		&& mayorName == other.mayorName
+		&& regionName == other.regionName
+		&& AreEqual(cityStats, other.cityStats)
+		&& AreEqual(regionStats, other.regionStats);
+}
+
+DiscordPresenceSnapshot::DiscordPresenceSnapshot(uint32_t version, const DiscordPresenceSnapshotData& data)
+	: refCount(0),
+	  version(version),
+	  data(data)
+{
+}
+
+bool DiscordPresenceSnapshot::QueryInterface(uint32_t riid, void** ppvObj)
+{
+	if (riid == GZIID_cIDiscordPresenceSnapshot)
+	{
+		*ppvObj = static_cast<cIDiscordPresenceSnapshot*>(this);
+		AddRef();
+
+		return true;
+	}
+	else if (riid == GZIID_cIGZUnknown)
+	{
+		*ppvObj = static_cast<cIGZUnknown*>(this);
+		AddRef();
+
+		return true;
+	}
+
+	return false;
+}
+
+uint32_t DiscordPresenceSnapshot::AddRef()
+{
+	return refCount.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+uint32_t DiscordPresenceSnapshot::Release()
+{
+	const uint32_t count = refCount.fetch_sub(1, std::memory_order_acq_rel) - 1;
+
+	if (count == 0)
+	{
+		delete this;
+	}
+
+	return count;
+}
+
+uint32_t DiscordPresenceSnapshot::GetVersion() const
+{
+	return version;
+}
+
+DiscordPresenceView DiscordPresenceSnapshot::GetView() const
+{
+	return data.view;
+}
+
+const DiscordPresenceCityStats* DiscordPresenceSnapshot::GetCityStats() const
+{
+	return data.view == DiscordPresenceView::EstablishedCity ? &data.cityStats : nullptr;
+}
+
+const char* DiscordPresenceSnapshot::GetCityName() const
+{
+	return data.cityName.c_str();
+}
+
+const char* DiscordPresenceSnapshot::GetMayorName() const
+{
+	return data.mayorName.c_str();
+}
+
+const char* DiscordPresenceSnapshot::GetRegionName() const
+{
+	return data.regionName.c_str();
+}
+
+const DiscordPresenceRegionStats* DiscordPresenceSnapshot::GetRegionStats() const
+{
+	return &data.regionStats;
+}
+
+const DiscordPresenceSnapshotData& DiscordPresenceSnapshot::GetData() const
+{
+	return data;
+}
@@ -0,0 +1,54 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-discord-rich-presence, a DLL Plugin for
+// SimCity 4 that implements Discord rich presence support.
+//
+// Copyright (c) 2024 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include "cIDiscordPresenceStats.h"
+#include <atomic>
+#include <string>
+
+struct DiscordPresenceSnapshotData
+{
+	DiscordPresenceView view;
+	std::string cityName;
+	std::string mayorName;
+	std::string regionName;
+	DiscordPresenceCityStats cityStats;
+	DiscordPresenceRegionStats regionStats;
+
+	bool operator==(const DiscordPresenceSnapshotData& other) const;
+};
+
+class DiscordPresenceSnapshot final : public cIDiscordPresenceSnapshot
+{
+public:
+	DiscordPresenceSnapshot(uint32_t version, const DiscordPresenceSnapshotData& data);
+
+	bool QueryInterface(uint32_t riid, void** ppvObj) override;
+	uint32_t AddRef() override;
+	uint32_t Release() override;
+
+	uint32_t GetVersion() const override;
+	DiscordPresenceView GetView() const override;
+	const DiscordPresenceCityStats* GetCityStats() const override;
+	const char* GetCityName() const override;
+	const char* GetMayorName() const override;
+	const char* GetRegionName() const override;
+	const DiscordPresenceRegionStats* GetRegionStats() const override;
+
+	const DiscordPresenceSnapshotData& GetData() const;
+
+private:
+	// Readers may hold and release the snapshot on other threads.
+	std::atomic<uint32_t> refCount;
+	const uint32_t version;
+	const DiscordPresenceSnapshotData data;
+};
@@ -0,0 +1,113 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-discord-rich-presence, a DLL Plugin for
+// SimCity 4 that implements Discord rich presence support.
+//
+// Copyright (c) 2024 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#include "DiscordRequestStats.h"
+#include "Logger.h"
+
+const char* GetDiscordRequestResultName(DiscordRequestResult result)
+{
+	switch (result)
+	{
+	case DiscordRequestResult::Ok:
+		return "Ok";
+	case DiscordRequestResult::DiscordError:
+		return "DiscordError";
+	case DiscordRequestResult::SendFailed:
+		return "SendFailed";
+	case DiscordRequestResult::TimedOut:
+		return "TimedOut";
+	case DiscordRequestResult::Disconnected:
+		return "Disconnected";
+	default:
+		return "Unknown";
+	}
+}
+
+DiscordRequestStats::DiscordRequestStats()
+	: resultCounts{},
+	  latencyBuckets{},
+	  totalLatency(),
+	  maxLatency(),
+	  completedRequests(0)
+{
+}
+
+void DiscordRequestStats::RecordResult(DiscordRequestResult result, std::chrono::steady_clock::duration latency)
+{
+	if (result < DiscordRequestResult::Count)
+	{
+		resultCounts[static_cast<size_t>(result)]++;
+	}
+
+	// Only the requests that Discord responded to have a meaningful round-trip time.
+	if (result == DiscordRequestResult::Ok || result == DiscordRequestResult::DiscordError)
+	{
+		const int64_t latencyMs = std::chrono::duration_cast<std::chrono::milliseconds>(latency).count();
+
+		size_t bucket = 0;
+
+		while (bucket < (LatencyBucketCount - 1) && latencyMs >= (int64_t(1) << bucket))
+		{
+			bucket++;
+		}
+
+		latencyBuckets[bucket]++;
+		totalLatency += latency;
+		completedRequests++;
+
+		if (latency > maxLatency)
+		{
+			maxLatency = latency;
+		}
+	}
+}
+
+uint64_t DiscordRequestStats::GetResultCount(DiscordRequestResult result) const
+{
+	return result < DiscordRequestResult::Count ? resultCounts[static_cast<size_t>(result)] : 0;
+}
+
+void DiscordRequestStats::WriteSummaryToLog() const
+{
+	LOG_INFO(
+		"Discord requests: Ok={}, DiscordError={}, SendFailed={}, TimedOut={}, Disconnected={}",
+		GetResultCount(DiscordRequestResult::Ok),
+		GetResultCount(DiscordRequestResult::DiscordError),
+		GetResultCount(DiscordRequestResult::SendFailed),
+		GetResultCount(DiscordRequestResult::TimedOut),
+		GetResultCount(DiscordRequestResult::Disconnected));
+
+	if (completedRequests > 0)
+	{
+		using FloatMilliseconds = std::chrono::duration<double, std::milli>;
+
+		LOG_INFO(
+			"Discord round-trip latency: average={:.1f} ms, max={:.1f} ms",
+			std::chrono::duration_cast<FloatMilliseconds>(totalLatency).count() / static_cast<double>(completedRequests),
+			std::chrono::duration_cast<FloatMilliseconds>(maxLatency).count());
+
+		for (size_t i = 0; i < LatencyBucketCount; i++)
+		{
+			if (latencyBuckets[i] > 0)
+			{
+				if (i < (LatencyBucketCount - 1))
+				{
+					LOG_INFO("  < {} ms: {}", int64_t(1) << i, latencyBuckets[i]);
+				}
+				else
+				{
+					LOG_INFO("  >= {} ms: {}", int64_t(1) << (i - 1), latencyBuckets[i]);
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,56 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-discord-rich-presence, a DLL Plugin for
+// SimCity 4 that implements Discord rich presence support.
+//
+// Copyright (c) 2024 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+enum class DiscordRequestResult : int32_t
+{
+	Ok = 0,
+	// Discord returned an ERROR event for the request.
+	DiscordError,
+	// The request could not be written to the pipe.
+	SendFailed,
+	// Discord did not respond before the request timeout.
+	TimedOut,
+	// The connection was closed before Discord responded.
+	Disconnected,
+	Count
+};
+
+const char* GetDiscordRequestResultName(DiscordRequestResult result);
+
+// The round-trip latency and result counts for the requests that are sent to Discord.
+class DiscordRequestStats
+{
+public:
+	DiscordRequestStats();
+
+	void RecordResult(DiscordRequestResult result, std::chrono::steady_clock::duration latency);
+
+	uint64_t GetResultCount(DiscordRequestResult result) const;
+
+	// Writes a summary of the request results and the latency histogram to the log.
+	void WriteSummaryToLog() const;
+
+private:
+	// The latency histogram uses power of two millisecond buckets: < 1 ms, < 2 ms, < 4 ms ... >= 8192 ms.
+	static constexpr size_t LatencyBucketCount = 15;
+
+	std::array<uint64_t, static_cast<size_t>(DiscordRequestResult::Count)> resultCounts;
+	std::array<uint64_t, LatencyBucketCount> latencyBuckets;
+	std::chrono::steady_clock::duration totalLatency;
+	std::chrono::steady_clock::duration maxLatency;
+	uint64_t completedRequests;
+};
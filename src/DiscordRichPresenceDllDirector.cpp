@@ -12,8 +12,11 @@
 
 #include "version.h"
 #include "DiscordRichPresenceService.h"
+#include "EASTLAllocatorSC4.h"
 #include "FileSystem.h"
+#include "FlightRecorder.h"
 #include "Logger.h"
+#include "Settings.h"
 #include "cIGZApp.h"
 #include "cIGZCOM.h"
 #include "cIGZFrameWork.h"
@@ -33,6 +36,7 @@
 #include <algorithm>
 #include <chrono>
 #include <filesystem>
+#include <fstream>
 #include <functional>
 #include <memory>
 #include <string>
@@ -42,12 +46,16 @@ static constexpr uint32_t kDiscordRichPresenceDirectorID = 0x7A559E00;
 using namespace std::string_view_literals;
 
 static constexpr std::string_view PluginLogFileName = "SC4DiscordRichPresence.log"sv;
+static constexpr std::string_view PluginSettingsFileName = "SC4DiscordRichPresence.ini"sv;
+static constexpr std::string_view FlightRecorderFileName = "SC4DiscordRichPresence.flightrecorder"sv;
+static constexpr std::string_view CrashLogFileName = "SC4DiscordRichPresence.crash.log"sv;
 
 class DiscordRichPresenceDllDirector final : public cRZCOMDllDirector
 {
 public:
 	DiscordRichPresenceDllDirector()
-		: service(),
+		: settings(),
+		  service(settings, PresenceClock::GetDefault()),
 		  serviceAddedToFramework(false),
 		  serviceAddedToOnIdle(false)
 	{
@@ -57,8 +65,35 @@ public:
 		logFilePath /= PluginLogFileName;
 
 		Logger& logger = Logger::GetInstance();
-		logger.Init(logFilePath, LogLevel::Info, false);
+		logger.Init(logFilePath, DefaultLogLevel, false);
 		logger.WriteLogFileHeader("SC4DiscordRichPresence v" PLUGIN_VERSION_STR);
+
+		std::filesystem::path settingsFilePath = dllFolderPath;
+		settingsFilePath /= PluginSettingsFileName;
+
+		settings.Load(settingsFilePath);
+
+		if (settings.GetFlightRecorderEnabled())
+		{
+			std::filesystem::path flightRecorderPath = dllFolderPath;
+			flightRecorderPath /= FlightRecorderFileName;
+
+			// Convert the events from a session that ended without closing the
+			// recorder to text before the file is overwritten.
+			if (FlightRecorder::WasSessionInterrupted(flightRecorderPath))
+			{
+				std::filesystem::path crashLogPath = dllFolderPath;
+				crashLogPath /= CrashLogFileName;
+
+				std::ofstream crashLog(crashLogPath, std::ofstream::out | std::ofstream::trunc);
+				FlightRecorder::Decode(flightRecorderPath, crashLog);
+			}
+
+			if (!logger.EnableFlightRecorder(flightRecorderPath, settings.GetFlightRecorderSizeInKB() * 1024))
+			{
+				LOG_ERROR("Failed to create the flight recorder file.");
+			}
+		}
 	}
 
 	uint32_t GetDirectorID() const
@@ -98,7 +133,7 @@ public:
 
 		if (!serviceAddedToOnIdle)
 		{
-			Logger::GetInstance().WriteLine(LogLevel::Error, "Failed to initialize the Discord Rich Presence service.");
+			LOG_ERROR("Failed to initialize the Discord Rich Presence service.");
 		}
 
 		return true;
@@ -120,11 +155,20 @@ public:
 
 		service.Shutdown();
 
+		// Release the allocator service reference before the framework shuts down its services.
+		EASTLAllocatorSC4::ReleaseAllocatorService();
+
+		// The game can exit without running the DLL's static destructors, so the recorder
+		// is closed here instead of relying on the Logger destructor.
+		// Nothing is logged after this point.
+		Logger::GetInstance().DisableFlightRecorder();
+
 		return true;
 	}
 
 private:
 
+	Settings settings;
 	DiscordRichPresenceService service;
 	bool serviceAddedToFramework;
 	bool serviceAddedToOnIdle;
@@ -13,6 +13,7 @@
 #include "DiscordRichPresenceService.h"
 #include "DebugUtil.h"
 #include "Logger.h"
+#include "Utf8Text.h"
 #include "cIGZFrameWork.h"
 #include "cIGZLanguageManager.h"
 #include "cIGZLanguageUtility.h"
@@ -21,18 +22,21 @@
 #include "cISC4App.h"
 #include "cISC4City.h"
 #include "cISC4Region.h"
+#include "cISC4Simulator.h"
 #include "cRZCOMDllDirector.h"
 #include "GZCLSIDDefs.h"
 #include "GZServPtrs.h"
 #include <array>
-
-static constexpr uint32_t kDiscordRichPresenceServiceID = 0xFE95AAEA;
+#include <cstring>
 
 static constexpr uint32_t kSC4MessagePostCityInit = 0x26D31EC1;
 static constexpr uint32_t kSC4MessageCityEstablished = 0x26D31EC4;
 static constexpr uint32_t kSC4MessageCityNameChanged = 0x0AB99380;
 static constexpr uint32_t kSC4MessagePostRegionInit = 0xCBB5BB45;
 static constexpr uint32_t kSC4MessagePreRegionShutdown = 0x8BB5BB46;
+// The service does not subscribe to this message, CityStatusProvider forwards it
+// to the task scheduler after it has refreshed its monthly values.
+static constexpr uint32_t kSC4MessageSimNewMonth = 0x66956816;
 
 static constexpr std::array<uint32_t, 5> MessageIds =
 {
@@ -43,33 +47,283 @@ static constexpr std::array<uint32_t, 5> MessageIds =
 	kSC4MessagePreRegionShutdown,
 };
 
+// The interval at which the status rotates when none of the values have changed significantly.
+static constexpr std::chrono::seconds StatusRotationInterval(30);
+
+// The slowest simulation speed, the values change more slowly at this speed so the
+// status rotates and is checked less often.
+static constexpr int32_t TurtleSimSpeed = 1;
+
+// The game reports a speed of 0 when the simulation is paused with the speed controls.
+static constexpr int32_t PausedSimSpeed = 0;
+
 namespace
 {
-	void DebugLogHook(discord::LogLevel level, const char* message)
+	void DiscordRequestCompleted(void* pContext, uint64_t requestId, DiscordRequestResult result)
 	{
-		DebugUtil::PrintLineToDebugOutputFormatted("Discord:%d %s", static_cast<int>(level), message);
+#ifdef _DEBUG
+		DebugUtil::PrintLineToDebugOutputFormatted(
+			"Discord request %llu result: %s",
+			requestId,
+			GetDiscordRequestResultName(result));
+#endif // _DEBUG
+
+		static_cast<ActivityUpdatePipeline*>(pContext)->RequestCompleted(requestId, result);
 	}
 
-	void DiscordAPICallback(discord::Result result)
+	// The names of the status types in the CityStatusTemplates section of the INI file,
+	// in the order of the CityStatusType values.
+	constexpr std::array<const char*, 23> CityStatusTypeNames =
 	{
-#ifdef _DEBUG
-		DebugUtil::PrintLineToDebugOutputFormatted("Discord result: %d", static_cast<int>(result));
-#endif // _DEBUG
+		"MayorName",
+		"MayorRating",
+		"ResidentialPopulation",
+		"CommercialPopulation",
+		"IndustrialPopulation",
+		"ResidentialWealthPopulation",
+		"CommercialSectorJobs",
+		"IndustrialSectorJobs",
+		"LotCount",
+		"BuildingCount",
+		"LandmarkCount",
+		"CityAgeInYears",
+		"MonthlyNetIncome",
+		"TotalFunds",
+		"LargestExpense",
+		"YearToDateBudget",
+		"EstimatedBudget",
+		"OutstandingLoans",
+		"AverageAirPollution",
+		"AverageWaterPollution",
+		"AveragePoliceCoverage",
+		"AverageAura",
+		"CriminalCount",
+	};
+
+	constexpr std::array<const char*, 15> RegionStatusTypeNames =
+	{
+		"TotalResidentialPopulation",
+		"TotalCommercialJobs",
+		"TotalIndustrialJobs",
+		"TotalFunds",
+		"TotalCities",
+		"DevelopedCityCount",
+		"UndevelopedCityCount",
+		"LargestCity",
+		"RichestCity",
+		"BorderingCities",
+		"StandaloneCities",
+		"DevelopedLand",
+		"DensestCity",
+		"CityClusters",
+		"LargestCityCluster",
+	};
+
+	enum class CityTemplateValue : uint16_t
+	{
+		MayorName,
+		MayorRating,
+		ResidentialPopulation,
+		CommercialPopulation,
+		IndustrialPopulation,
+		ResidentialLowWealth,
+		ResidentialMediumWealth,
+		ResidentialHighWealth,
+		ServicesJobs,
+		OfficeJobs,
+		AgricultureJobs,
+		DirtyIndustryJobs,
+		ManufacturingJobs,
+		HighTechJobs,
+		LotCount,
+		BuildingCount,
+		LandmarkCount,
+		CityAgeInYears,
+		MonthlyNetIncome,
+		TotalFunds,
+		LargestExpense,
+		LargestExpenseDepartment,
+		YearToDateIncome,
+		YearToDateExpenses,
+		EstimatedIncome,
+		EstimatedExpenses,
+		LoanCount,
+		TotalBorrowed,
+		AverageAirPollution,
+		AverageWaterPollution,
+		AveragePoliceCoverage,
+		AverageAura,
+		CriminalCount,
+		Count
+	};
+
+	constexpr std::array<StatusTemplateVariable, static_cast<size_t>(CityTemplateValue::Count)> CityTemplateVariables =
+	{
+		StatusTemplateVariable{ "mayor_name", StatusTemplateFormat::Text },
+		StatusTemplateVariable{ "mayor_rating", StatusTemplateFormat::Number },
+		StatusTemplateVariable{ "res_pop", StatusTemplateFormat::Number },
+		StatusTemplateVariable{ "com_pop", StatusTemplateFormat::Number },
+		StatusTemplateVariable{ "ind_pop", StatusTemplateFormat::Number },
+		StatusTemplateVariable{ "res_low", StatusTemplateFormat::Number },
+		StatusTemplateVariable{ "res_med", StatusTemplateFormat::Number },
+		StatusTemplateVariable{ "res_high", StatusTemplateFormat::Number },
+		StatusTemplateVariable{ "services_jobs", StatusTemplateFormat::Number },
+		StatusTemplateVariable{ "office_jobs", StatusTemplateFormat::Number },
+		StatusTemplateVariable{ "agriculture_jobs", StatusTemplateFormat::Number },
+		StatusTemplateVariable{ "dirty_jobs", StatusTemplateFormat::Number },
+		StatusTemplateVariable{ "manufacturing_jobs", StatusTemplateFormat::Number },
+		StatusTemplateVariable{ "high_tech_jobs", StatusTemplateFormat::Number },
+		StatusTemplateVariable{ "lots", StatusTemplateFormat::Number },
+		StatusTemplateVariable{ "buildings", StatusTemplateFormat::Number },
+		StatusTemplateVariable{ "landmarks", StatusTemplateFormat::Number },
+		StatusTemplateVariable{ "city_age", StatusTemplateFormat::Number },
+		StatusTemplateVariable{ "net_income", StatusTemplateFormat::Money },
+		StatusTemplateVariable{ "funds", StatusTemplateFormat::Money },
+		StatusTemplateVariable{ "largest_expense", StatusTemplateFormat::Money },
+		StatusTemplateVariable{ "largest_expense_department", StatusTemplateFormat::Text },
+		StatusTemplateVariable{ "ytd_income", StatusTemplateFormat::Money },
+		StatusTemplateVariable{ "ytd_expenses", StatusTemplateFormat::Money },
+		StatusTemplateVariable{ "est_income", StatusTemplateFormat::Money },
+		StatusTemplateVariable{ "est_expenses", StatusTemplateFormat::Money },
+		StatusTemplateVariable{ "loans", StatusTemplateFormat::Number },
+		StatusTemplateVariable{ "borrowed", StatusTemplateFormat::Money },
+		StatusTemplateVariable{ "air_pollution", StatusTemplateFormat::Number },
+		StatusTemplateVariable{ "water_pollution", StatusTemplateFormat::Number },
+		StatusTemplateVariable{ "police_coverage", StatusTemplateFormat::Number },
+		StatusTemplateVariable{ "aura", StatusTemplateFormat::Number },
+		StatusTemplateVariable{ "criminals", StatusTemplateFormat::Number },
+	};
+
+	enum class RegionTemplateValue : uint16_t
+	{
+		TotalResidentialPopulation,
+		TotalCommercialJobs,
+		TotalIndustrialJobs,
+		TotalFunds,
+		TotalCities,
+		DevelopedCityCount,
+		UndevelopedCityCount,
+		LargestCityName,
+		LargestCityPopulation,
+		RichestCityName,
+		RichestCityFunds,
+		BorderingCities,
+		StandaloneCities,
+		DevelopedLandPercentage,
+		DevelopedCellCount,
+		DensestCityName,
+		DensestCityDensity,
+		CityClusters,
+		LargestCityCluster,
+		Count
+	};
+
+	constexpr std::array<StatusTemplateVariable, static_cast<size_t>(RegionTemplateValue::Count)> RegionTemplateVariables =
+	{
+		StatusTemplateVariable{ "res_pop", StatusTemplateFormat::Number },
+		StatusTemplateVariable{ "com_jobs", StatusTemplateFormat::Number },
+		StatusTemplateVariable{ "ind_jobs", StatusTemplateFormat::Number },
+		StatusTemplateVariable{ "funds", StatusTemplateFormat::Money },
+		StatusTemplateVariable{ "cities", StatusTemplateFormat::Number },
+		StatusTemplateVariable{ "developed_cities", StatusTemplateFormat::Number },
+		StatusTemplateVariable{ "undeveloped_cities", StatusTemplateFormat::Number },
+		StatusTemplateVariable{ "largest_city", StatusTemplateFormat::Text },
+		StatusTemplateVariable{ "largest_city_pop", StatusTemplateFormat::Number },
+		StatusTemplateVariable{ "richest_city", StatusTemplateFormat::Text },
+		StatusTemplateVariable{ "richest_city_funds", StatusTemplateFormat::Money },
+		StatusTemplateVariable{ "bordering_cities", StatusTemplateFormat::Number },
+		StatusTemplateVariable{ "standalone_cities", StatusTemplateFormat::Number },
+		StatusTemplateVariable{ "developed_land", StatusTemplateFormat::Number },
+		StatusTemplateVariable{ "developed_cells", StatusTemplateFormat::Number },
+		StatusTemplateVariable{ "densest_city", StatusTemplateFormat::Text },
+		StatusTemplateVariable{ "densest_city_density", StatusTemplateFormat::Number },
+		StatusTemplateVariable{ "city_clusters", StatusTemplateFormat::Number },
+		StatusTemplateVariable{ "largest_cluster", StatusTemplateFormat::Number },
+	};
+
+	void SetNumber(StatusTemplateValue* values, CityTemplateValue index, int64_t number)
+	{
+		values[static_cast<size_t>(index)] = StatusTemplateValue{ nullptr, number };
+	}
+
+	void SetText(StatusTemplateValue* values, CityTemplateValue index, const char* text)
+	{
+		values[static_cast<size_t>(index)] = StatusTemplateValue{ text, 0 };
+	}
+
+	void SetNumber(StatusTemplateValue* values, RegionTemplateValue index, int64_t number)
+	{
+		values[static_cast<size_t>(index)] = StatusTemplateValue{ nullptr, number };
+	}
+
+	void SetText(StatusTemplateValue* values, RegionTemplateValue index, const char* text)
+	{
+		values[static_cast<size_t>(index)] = StatusTemplateValue{ text, 0 };
+	}
+
+	template <size_t N>
+	void CompileTemplates(
+		const char* sectionName,
+		const std::vector<StatusTemplateSetting>& settings,
+		const std::array<const char*, N>& statusTypeNames,
+		std::array<StatusTemplate, N>& templates,
+		const StatusTemplateVariable* variables,
+		size_t variableCount)
+	{
+		for (const StatusTemplateSetting& setting : settings)
+		{
+			size_t index = N;
+
+			for (size_t i = 0; i < N; i++)
+			{
+				if (setting.name == statusTypeNames[i])
+				{
+					index = i;
+					break;
+				}
+			}
+
+			if (index == N)
+			{
+				LOG_ERROR("Unknown status type in {}: {}", sectionName, setting.name);
+				continue;
+			}
+
+			std::string errorMessage;
+
+			if (!templates[index].Compile(setting.text, variables, variableCount, errorMessage))
+			{
+				LOG_ERROR("Invalid {} template for {}: {}", sectionName, setting.name, errorMessage);
+			}
+		}
 	}
 }
 
-DiscordRichPresenceService::DiscordRichPresenceService()
+DiscordRichPresenceService::DiscordRichPresenceService(const Settings& settings, const PresenceClock& clock)
 	: ServiceBase(kDiscordRichPresenceServiceID, 2000010),
-	  discord(),
+	  clock(clock),
+	  discordClient(APPLICATION_ID, clock),
+	  updatePipeline(discordClient, clock),
 	  activity{},
-	  activityLastUpdateTime(),
-	  statusLastUpdateTime(),
 	  activityNeedsUpdate(false),
+	  settings(settings),
+	  cityStatusScheduler(static_cast<size_t>(CityStatusType::Count), StatusRotationInterval),
+	  regionStatusScheduler(static_cast<size_t>(RegionStatusType::Count), StatusRotationInterval),
 	  currentCityStatus(CityStatusType::MayorName),
 	  currentRegionStatus(RegionStatusType::TotalResidentialPopulation),
 	  view(DiscordView::Unknown),
-	  pLanguageUtility(nullptr)
+	  pLanguageUtility(nullptr),
+	  taskScheduler(),
+	  idleTimeBudget(std::chrono::microseconds::zero(), clock),
+	  simulationSpeed(0),
+	  simulationPaused(false),
+	  cityName(),
+	  regionName(),
+	  pSnapshot(nullptr),
+	  snapshotVersion(0)
 {
+	discordClient.SetRequestCompletedCallback(DiscordRequestCompleted, &updatePipeline);
+	cityStatusProvider.SetMonthlyValuesUpdatedCallback(CityMonthlyValuesUpdated, this);
 }
 
 bool DiscordRichPresenceService::QueryInterface(uint32_t riid, void** ppvObj)
@@ -81,6 +335,13 @@ bool DiscordRichPresenceService::QueryInterface(uint32_t riid, void** ppvObj)
 
 		return true;
 	}
+	else if (riid == GZIID_cIDiscordPresenceStats)
+	{
+		*ppvObj = static_cast<cIDiscordPresenceStats*>(this);
+		AddRef();
+
+		return true;
+	}
 
 	return ServiceBase::QueryInterface(riid, ppvObj);
 }
@@ -106,6 +367,10 @@ bool DiscordRichPresenceService::Init()
 
 	if (pLM && pMS2)
 	{
+		cityStatusScheduler.SetSignificanceThreshold(settings.GetSignificanceThreshold());
+		regionStatusScheduler.SetSignificanceThreshold(settings.GetSignificanceThreshold());
+		idleTimeBudget.SetBudget(std::chrono::microseconds(settings.GetIdleTimeBudgetInMicroseconds()));
+
 		for (const auto& id : MessageIds)
 		{
 			pMS2->AddNotification(this, id);
@@ -119,30 +384,18 @@ bool DiscordRichPresenceService::Init()
 
 			if (result)
 			{
-				discord::Core* instance = nullptr;
-
-				discord::Result discordStatus = discord::Core::Create(APPLICATION_ID, DiscordCreateFlags_NoRequireDiscord, &instance);
+				activity.SetLargeImage("sc4_icon_1024");
 
-				if (discordStatus == discord::Result::Ok)
-				{
-					discord.reset(instance);
+				CompileStatusTemplates();
 
-#ifdef _DEBUG
-					discord->SetLogHook(discord::LogLevel::Debug, DebugLogHook);
-#endif // _DEBUG
+				taskScheduler.Start(StatusSelectionTask());
+				taskScheduler.Start(CityValuesTask());
 
-					activity.GetAssets().SetLargeImage("sc4_icon_1024");
-					activity.SetType(discord::ActivityType::Playing);
+				PublishSnapshot();
 
-					// Set the user's status to Playing.
-					activityLastUpdateTime = std::chrono::system_clock::now();
-					discord->ActivityManager().UpdateActivity(activity, DiscordAPICallback);
-					result = discord->RunCallbacks() == discord::Result::Ok;
-				}
-				else
-				{
-					result = false;
-				}
+				// The connection to Discord is made from OnIdle, the user's status is set
+				// to Playing when the connection is ready.
+				activityNeedsUpdate = true;
 			}
 		}
 		else
@@ -172,12 +425,19 @@ bool DiscordRichPresenceService::Shutdown()
 		pLanguageUtility = nullptr;
 	}
 
-	if (discord)
+	taskScheduler.Clear();
+
+	if (pSnapshot)
 	{
-		discord->ActivityManager().ClearActivity(DiscordAPICallback);
-		discord->RunCallbacks();
+		// Other plugins may still hold a reference to the snapshot.
+		pSnapshot->Release();
+		pSnapshot = nullptr;
 	}
 
+	discordClient.ClearActivity();
+	discordClient.Disconnect();
+	discordClient.GetRequestStats().WriteSummaryToLog();
+
 	return cityStatusProvider.Shutdown();
 }
 
@@ -234,6 +494,10 @@ bool DiscordRichPresenceService::DoMessage(cIGZMessage2* pMsg)
 		break;
 	}
 
+	taskScheduler.NotifyMessage(pStandardMsg->GetType());
+
+	PublishSnapshot();
+
 	return true;
 }
 
@@ -277,7 +541,7 @@ void DiscordRichPresenceService::PostCityInit(cIGZMessage2Standard* pStandardMsg
 
 			activity.SetDetails(details.c_str());
 			activity.SetState("");
-			activity.GetTimestamps().SetStart(0);
+			activity.SetStartTimestamp(0);
 			view = DiscordView::UnestablishedCity;
 			activityNeedsUpdate = true;
 		}
@@ -310,23 +574,294 @@ void DiscordRichPresenceService::PostRegionInit()
 
 				cIGZString* name = reinterpret_cast<cIGZString*>(reinterpret_cast<void**>(pRegion->GetName()));
 
+				regionName = Utf8Text::ToValidUtf8(name->ToChar(), name->Strlen());
+
 				std::string details("Region: ");
-				details.append(name->ToChar(), name->Strlen());
+				details.append(regionName);
 
 				activity.SetDetails(details.c_str());
 
 				regionStatusProvider.SetupRegionStatusData(pRegion);
 				currentRegionStatus = RegionStatusType::TotalResidentialPopulation;
+				UpdateRegionStatusValues();
+				regionStatusScheduler.Reset(static_cast<size_t>(currentRegionStatus), clock.GetSystemTime());
 				SetRegionStatusText();
-				activity.GetTimestamps().SetStart(0);
+				activity.SetStartTimestamp(0);
 				activityNeedsUpdate = true;
 			}
 		}
 	}
 }
 
-void DiscordRichPresenceService::SetCityStatusText()
+double DiscordRichPresenceService::GetCityStatusValue(CityStatusType type) const
+{
+	const CityStatusProvider::BudgetSnapshot& budget = cityStatusProvider.GetBudgetSnapshot();
+
+	switch (type)
+	{
+	case CityStatusType::MayorRating:
+		return cityStatusProvider.GetMayorRating();
+	case CityStatusType::ResidentialPopulation:
+		return cityStatusProvider.GetResidentalPopulation();
+	case CityStatusType::CommercialPopulation:
+	case CityStatusType::CommercialSectorJobs:
+		return cityStatusProvider.GetCommercialPopulation();
+	case CityStatusType::IndustrialPopulation:
+	case CityStatusType::IndustrialSectorJobs:
+		return cityStatusProvider.GetIndustrialPopulation();
+	case CityStatusType::ResidentialWealthPopulation:
+		return static_cast<double>(cityStatusProvider.GetCensusValue(CityStatusProvider::CensusType::ResidentialLowWealth))
+			+ cityStatusProvider.GetCensusValue(CityStatusProvider::CensusType::ResidentialMediumWealth)
+			+ cityStatusProvider.GetCensusValue(CityStatusProvider::CensusType::ResidentialHighWealth);
+	case CityStatusType::LotCount:
+		return cityStatusProvider.GetLotCount();
+	case CityStatusType::BuildingCount:
+		return cityStatusProvider.GetBuildingCount();
+	case CityStatusType::LandmarkCount:
+		return cityStatusProvider.GetLandmarkCount();
+	case CityStatusType::CityAgeInYears:
+		return cityStatusProvider.GetCityAgeInYears();
+	case CityStatusType::MonthlyNetIncome:
+		return cityStatusProvider.GetMonthlyNetIncome();
+	case CityStatusType::TotalFunds:
+		return static_cast<double>(cityStatusProvider.GetTotalFunds());
+	case CityStatusType::LargestExpense:
+		return static_cast<double>(budget.largestDepartmentExpense);
+	case CityStatusType::YearToDateBudget:
+		return static_cast<double>(budget.yearToDateIncome - budget.yearToDateExpenses);
+	case CityStatusType::EstimatedBudget:
+		return static_cast<double>(budget.estimatedIncome - budget.estimatedExpenses);
+	case CityStatusType::OutstandingLoans:
+		return static_cast<double>(budget.totalBorrowed);
+	case CityStatusType::AverageAirPollution:
+		return cityStatusProvider.GetAverageAirPollution();
+	case CityStatusType::AverageWaterPollution:
+		return cityStatusProvider.GetAverageWaterPollution();
+	case CityStatusType::AveragePoliceCoverage:
+		return cityStatusProvider.GetAveragePoliceCoverage();
+	case CityStatusType::AverageAura:
+		return cityStatusProvider.GetAverageAura();
+	case CityStatusType::CriminalCount:
+		return cityStatusProvider.GetCriminalCount();
+	case CityStatusType::MayorName:
+	default:
+		// The mayor name is only shown when the status rotates.
+		return 0.0;
+	}
+}
+
+double DiscordRichPresenceService::GetRegionStatusValue(RegionStatusType type) const
 {
+	const RegionStatusProvider::RegionalCityInfo* pLargestCity = regionStatusProvider.GetLargestCity();
+	const RegionStatusProvider::RegionalCityInfo* pRichestCity = regionStatusProvider.GetRichestCity();
+	const RegionStatusProvider::RegionalCityInfo* pDensestCity = regionStatusProvider.GetDensestCity();
+
+	switch (type)
+	{
+	case RegionStatusType::TotalResidentialPopulation:
+		return static_cast<double>(regionStatusProvider.GetTotalResidentialPopulation());
+	case RegionStatusType::TotalCommercialJobs:
+		return static_cast<double>(regionStatusProvider.GetTotalCommercialJobs());
+	case RegionStatusType::TotalIndustrialJobs:
+		return static_cast<double>(regionStatusProvider.GetTotalIndustrialJobs());
+	case RegionStatusType::TotalFunds:
+		return static_cast<double>(regionStatusProvider.GetTotalFunds());
+	case RegionStatusType::TotalCities:
+		return regionStatusProvider.GetTotalCities();
+	case RegionStatusType::DevelopedCityCount:
+		return regionStatusProvider.GetDevelopedCityCount();
+	case RegionStatusType::UndevelopedCityCount:
+		return regionStatusProvider.GetUndevelopedCityCount();
+	case RegionStatusType::LargestCity:
+		return pLargestCity ? static_cast<double>(pLargestCity->population) : 0.0;
+	case RegionStatusType::RichestCity:
+		return pRichestCity ? static_cast<double>(pRichestCity->funds) : 0.0;
+	case RegionStatusType::BorderingCities:
+		return regionStatusProvider.GetBorderingCityCount();
+	case RegionStatusType::StandaloneCities:
+		return regionStatusProvider.GetStandaloneCityCount();
+	case RegionStatusType::DevelopedLand:
+		return regionStatusProvider.GetDevelopedLandPercentage();
+	case RegionStatusType::DensestCity:
+		return pDensestCity ? static_cast<double>(pDensestCity->density) : 0.0;
+	case RegionStatusType::CityClusters:
+		return regionStatusProvider.GetCityClusterCount();
+	case RegionStatusType::LargestCityCluster:
+		return regionStatusProvider.GetLargestCityClusterSize();
+	default:
+		return 0.0;
+	}
+}
+
+void DiscordRichPresenceService::UpdateCityStatusValues()
+{
+	for (size_t i = 0; i < static_cast<size_t>(CityStatusType::Count); i++)
+	{
+		cityStatusScheduler.SetValue(i, GetCityStatusValue(static_cast<CityStatusType>(i)));
+	}
+}
+
+void DiscordRichPresenceService::UpdateRegionStatusValues()
+{
+	for (size_t i = 0; i < static_cast<size_t>(RegionStatusType::Count); i++)
+	{
+		regionStatusScheduler.SetValue(i, GetRegionStatusValue(static_cast<RegionStatusType>(i)));
+	}
+}
+
+void DiscordRichPresenceService::SelectNextCityStatus(StatusScheduler::TimePoint now)
+{
+	size_t index = 0;
+
+	// A significant change is shown immediately, otherwise the status
+	// rotates to the highest scoring value.
+	if (cityStatusScheduler.SelectSignificantChange(index)
+		|| cityStatusScheduler.SelectNext(index, now))
+	{
+		cityStatusScheduler.MarkShown(index, now);
+		currentCityStatus = static_cast<CityStatusType>(index);
+
+		// Skip the update if the text that Discord is showing has not changed.
+		if (SetCityStatusText())
+		{
+			activityNeedsUpdate = true;
+		}
+	}
+}
+
+void DiscordRichPresenceService::SelectNextRegionStatus(StatusScheduler::TimePoint now)
+{
+	size_t index = 0;
+
+	if (regionStatusScheduler.SelectSignificantChange(index)
+		|| regionStatusScheduler.SelectNext(index, now))
+	{
+		regionStatusScheduler.MarkShown(index, now);
+		currentRegionStatus = static_cast<RegionStatusType>(index);
+
+		if (SetRegionStatusText())
+		{
+			activityNeedsUpdate = true;
+		}
+	}
+}
+
+void DiscordRichPresenceService::CompileStatusTemplates()
+{
+	static_assert(CityStatusTypeNames.size() == static_cast<size_t>(CityStatusType::Count));
+	static_assert(RegionStatusTypeNames.size() == static_cast<size_t>(RegionStatusType::Count));
+
+	CompileTemplates(
+		"CityStatusTemplates",
+		settings.GetCityStatusTemplates(),
+		CityStatusTypeNames,
+		cityStatusTemplates,
+		CityTemplateVariables.data(),
+		CityTemplateVariables.size());
+	CompileTemplates(
+		"RegionStatusTemplates",
+		settings.GetRegionStatusTemplates(),
+		RegionStatusTypeNames,
+		regionStatusTemplates,
+		RegionTemplateVariables.data(),
+		RegionTemplateVariables.size());
+}
+
+void DiscordRichPresenceService::GetCityTemplateValues(StatusTemplateValue* values) const
+{
+	typedef CityStatusProvider::CensusType CensusType;
+
+	const CityStatusProvider::BudgetSnapshot& budget = cityStatusProvider.GetBudgetSnapshot();
+
+	SetText(values, CityTemplateValue::MayorName, cityStatusProvider.GetMayorName().ToChar());
+	SetNumber(values, CityTemplateValue::MayorRating, cityStatusProvider.GetMayorRating());
+	SetNumber(values, CityTemplateValue::ResidentialPopulation, cityStatusProvider.GetResidentalPopulation());
+	SetNumber(values, CityTemplateValue::CommercialPopulation, cityStatusProvider.GetCommercialPopulation());
+	SetNumber(values, CityTemplateValue::IndustrialPopulation, cityStatusProvider.GetIndustrialPopulation());
+	SetNumber(values, CityTemplateValue::ResidentialLowWealth, cityStatusProvider.GetCensusValue(CensusType::ResidentialLowWealth));
+	SetNumber(values, CityTemplateValue::ResidentialMediumWealth, cityStatusProvider.GetCensusValue(CensusType::ResidentialMediumWealth));
+	SetNumber(values, CityTemplateValue::ResidentialHighWealth, cityStatusProvider.GetCensusValue(CensusType::ResidentialHighWealth));
+	SetNumber(
+		values,
+		CityTemplateValue::ServicesJobs,
+		static_cast<int64_t>(cityStatusProvider.GetCensusValue(CensusType::CommercialServicesLowWealth))
+		+ cityStatusProvider.GetCensusValue(CensusType::CommercialServicesMediumWealth)
+		+ cityStatusProvider.GetCensusValue(CensusType::CommercialServicesHighWealth));
+	SetNumber(
+		values,
+		CityTemplateValue::OfficeJobs,
+		static_cast<int64_t>(cityStatusProvider.GetCensusValue(CensusType::CommercialOfficeMediumWealth))
+		+ cityStatusProvider.GetCensusValue(CensusType::CommercialOfficeHighWealth));
+	SetNumber(values, CityTemplateValue::AgricultureJobs, cityStatusProvider.GetCensusValue(CensusType::IndustrialAgriculture));
+	SetNumber(values, CityTemplateValue::DirtyIndustryJobs, cityStatusProvider.GetCensusValue(CensusType::IndustrialDirty));
+	SetNumber(values, CityTemplateValue::ManufacturingJobs, cityStatusProvider.GetCensusValue(CensusType::IndustrialManufacturing));
+	SetNumber(values, CityTemplateValue::HighTechJobs, cityStatusProvider.GetCensusValue(CensusType::IndustrialHighTech));
+	SetNumber(values, CityTemplateValue::LotCount, cityStatusProvider.GetLotCount());
+	SetNumber(values, CityTemplateValue::BuildingCount, cityStatusProvider.GetBuildingCount());
+	SetNumber(values, CityTemplateValue::LandmarkCount, cityStatusProvider.GetLandmarkCount());
+	SetNumber(values, CityTemplateValue::CityAgeInYears, cityStatusProvider.GetCityAgeInYears());
+	SetNumber(values, CityTemplateValue::MonthlyNetIncome, cityStatusProvider.GetMonthlyNetIncome());
+	SetNumber(values, CityTemplateValue::TotalFunds, cityStatusProvider.GetTotalFunds());
+	SetNumber(values, CityTemplateValue::LargestExpense, budget.largestDepartmentExpense);
+	SetText(values, CityTemplateValue::LargestExpenseDepartment, budget.largestExpenseDepartmentName.ToChar());
+	SetNumber(values, CityTemplateValue::YearToDateIncome, budget.yearToDateIncome);
+	SetNumber(values, CityTemplateValue::YearToDateExpenses, budget.yearToDateExpenses);
+	SetNumber(values, CityTemplateValue::EstimatedIncome, budget.estimatedIncome);
+	SetNumber(values, CityTemplateValue::EstimatedExpenses, budget.estimatedExpenses);
+	SetNumber(values, CityTemplateValue::LoanCount, budget.loanCount);
+	SetNumber(values, CityTemplateValue::TotalBorrowed, budget.totalBorrowed);
+	SetNumber(values, CityTemplateValue::AverageAirPollution, cityStatusProvider.GetAverageAirPollution());
+	SetNumber(values, CityTemplateValue::AverageWaterPollution, cityStatusProvider.GetAverageWaterPollution());
+	SetNumber(values, CityTemplateValue::AveragePoliceCoverage, cityStatusProvider.GetAveragePoliceCoverage());
+	SetNumber(values, CityTemplateValue::AverageAura, cityStatusProvider.GetAverageAura());
+	SetNumber(values, CityTemplateValue::CriminalCount, cityStatusProvider.GetCriminalCount());
+}
+
+void DiscordRichPresenceService::GetRegionTemplateValues(StatusTemplateValue* values) const
+{
+	SetNumber(values, RegionTemplateValue::TotalResidentialPopulation, regionStatusProvider.GetTotalResidentialPopulation());
+	SetNumber(values, RegionTemplateValue::TotalCommercialJobs, regionStatusProvider.GetTotalCommercialJobs());
+	SetNumber(values, RegionTemplateValue::TotalIndustrialJobs, regionStatusProvider.GetTotalIndustrialJobs());
+	SetNumber(values, RegionTemplateValue::TotalFunds, regionStatusProvider.GetTotalFunds());
+	SetNumber(values, RegionTemplateValue::TotalCities, regionStatusProvider.GetTotalCities());
+	SetNumber(values, RegionTemplateValue::DevelopedCityCount, regionStatusProvider.GetDevelopedCityCount());
+	SetNumber(values, RegionTemplateValue::UndevelopedCityCount, regionStatusProvider.GetUndevelopedCityCount());
+
+	const RegionStatusProvider::RegionalCityInfo* pLargestCity = regionStatusProvider.GetLargestCity();
+	const RegionStatusProvider::RegionalCityInfo* pRichestCity = regionStatusProvider.GetRichestCity();
+
+	SetText(values, RegionTemplateValue::LargestCityName, pLargestCity ? pLargestCity->name.c_str() : "");
+	SetNumber(values, RegionTemplateValue::LargestCityPopulation, pLargestCity ? pLargestCity->population : 0);
+	SetText(values, RegionTemplateValue::RichestCityName, pRichestCity ? pRichestCity->name.c_str() : "");
+	SetNumber(values, RegionTemplateValue::RichestCityFunds, pRichestCity ? pRichestCity->funds : 0);
+	SetNumber(values, RegionTemplateValue::BorderingCities, regionStatusProvider.GetBorderingCityCount());
+	SetNumber(values, RegionTemplateValue::StandaloneCities, regionStatusProvider.GetStandaloneCityCount());
+	SetNumber(values, RegionTemplateValue::DevelopedLandPercentage, regionStatusProvider.GetDevelopedLandPercentage());
+	SetNumber(values, RegionTemplateValue::DevelopedCellCount, regionStatusProvider.GetDevelopedCellCount());
+
+	const RegionStatusProvider::RegionalCityInfo* pDensestCity = regionStatusProvider.GetDensestCity();
+
+	SetText(values, RegionTemplateValue::DensestCityName, pDensestCity ? pDensestCity->name.c_str() : "");
+	SetNumber(values, RegionTemplateValue::DensestCityDensity, pDensestCity ? pDensestCity->density : 0);
+	SetNumber(values, RegionTemplateValue::CityClusters, regionStatusProvider.GetCityClusterCount());
+	SetNumber(values, RegionTemplateValue::LargestCityCluster, regionStatusProvider.GetLargestCityClusterSize());
+}
+
+bool DiscordRichPresenceService::SetCityStatusText()
+{
+	const StatusTemplate& statusTemplate = cityStatusTemplates[static_cast<size_t>(currentCityStatus)];
+
+	if (!statusTemplate.IsEmpty())
+	{
+		std::array<StatusTemplateValue, static_cast<size_t>(CityTemplateValue::Count)> values;
+		GetCityTemplateValues(values.data());
+
+		char text[DiscordActivity::MaxStringLength];
+		statusTemplate.Render(values.data(), values.size(), text, sizeof(text));
+
+		return SetStateText(text);
+	}
+
 	char buffer[1024]{};
 
 	switch (currentCityStatus)
@@ -363,6 +898,60 @@ void DiscordRichPresenceService::SetCityStatusText()
 			"Industrial Pop. %s",
 			GetUSEnglishNumberString(cityStatusProvider.GetIndustrialPopulation()).ToChar());
 		break;
+	case CityStatusType::ResidentialWealthPopulation:
+		// The section symbol is encoded as UTF-8, see GetUSEnglishNumberString.
+		std::snprintf(
+			buffer,
+			sizeof(buffer),
+			"R\xC2\xA7 %s, R\xC2\xA7\xC2\xA7 %s, R\xC2\xA7\xC2\xA7\xC2\xA7 %s",
+			GetUSEnglishNumberString(cityStatusProvider.GetCensusValue(CityStatusProvider::CensusType::ResidentialLowWealth)).ToChar(),
+			GetUSEnglishNumberString(cityStatusProvider.GetCensusValue(CityStatusProvider::CensusType::ResidentialMediumWealth)).ToChar(),
+			GetUSEnglishNumberString(cityStatusProvider.GetCensusValue(CityStatusProvider::CensusType::ResidentialHighWealth)).ToChar());
+		break;
+	case CityStatusType::CommercialSectorJobs:
+		std::snprintf(
+			buffer,
+			sizeof(buffer),
+			"Services Jobs %s, Office Jobs %s",
+			GetUSEnglishNumberString(
+				cityStatusProvider.GetCensusValue(CityStatusProvider::CensusType::CommercialServicesLowWealth)
+				+ cityStatusProvider.GetCensusValue(CityStatusProvider::CensusType::CommercialServicesMediumWealth)
+				+ cityStatusProvider.GetCensusValue(CityStatusProvider::CensusType::CommercialServicesHighWealth)).ToChar(),
+			GetUSEnglishNumberString(
+				cityStatusProvider.GetCensusValue(CityStatusProvider::CensusType::CommercialOfficeMediumWealth)
+				+ cityStatusProvider.GetCensusValue(CityStatusProvider::CensusType::CommercialOfficeHighWealth)).ToChar());
+		break;
+	case CityStatusType::IndustrialSectorJobs:
+		std::snprintf(
+			buffer,
+			sizeof(buffer),
+			"Agriculture %s, Dirty %s, Manufacturing %s, High-Tech %s",
+			GetUSEnglishNumberString(cityStatusProvider.GetCensusValue(CityStatusProvider::CensusType::IndustrialAgriculture)).ToChar(),
+			GetUSEnglishNumberString(cityStatusProvider.GetCensusValue(CityStatusProvider::CensusType::IndustrialDirty)).ToChar(),
+			GetUSEnglishNumberString(cityStatusProvider.GetCensusValue(CityStatusProvider::CensusType::IndustrialManufacturing)).ToChar(),
+			GetUSEnglishNumberString(cityStatusProvider.GetCensusValue(CityStatusProvider::CensusType::IndustrialHighTech)).ToChar());
+		break;
+	case CityStatusType::LotCount:
+		std::snprintf(
+			buffer,
+			sizeof(buffer),
+			"Lots: %s",
+			GetUSEnglishNumberString(cityStatusProvider.GetLotCount()).ToChar());
+		break;
+	case CityStatusType::BuildingCount:
+		std::snprintf(
+			buffer,
+			sizeof(buffer),
+			"Buildings: %s",
+			GetUSEnglishNumberString(cityStatusProvider.GetBuildingCount()).ToChar());
+		break;
+	case CityStatusType::LandmarkCount:
+		std::snprintf(
+			buffer,
+			sizeof(buffer),
+			"Landmarks: %s",
+			GetUSEnglishNumberString(cityStatusProvider.GetLandmarkCount()).ToChar());
+		break;
 
 	case CityStatusType::CityAgeInYears:
 		std::snprintf(
@@ -385,13 +974,104 @@ void DiscordRichPresenceService::SetCityStatusText()
 			"Total Funds: %s",
 			GetUSEnglishNumberString(cityStatusProvider.GetTotalFunds(), NumberType::Money).ToChar());
 		break;
+	case CityStatusType::LargestExpense:
+		if (cityStatusProvider.GetBudgetSnapshot().largestExpenseDepartmentName.Strlen() > 0)
+		{
+			std::snprintf(
+				buffer,
+				sizeof(buffer),
+				"Largest Expense: %s %s",
+				cityStatusProvider.GetBudgetSnapshot().largestExpenseDepartmentName.ToChar(),
+				GetUSEnglishNumberString(cityStatusProvider.GetBudgetSnapshot().largestDepartmentExpense, NumberType::Money).ToChar());
+		}
+		else
+		{
+			std::snprintf(
+				buffer,
+				sizeof(buffer),
+				"Largest Expense: %s",
+				GetUSEnglishNumberString(cityStatusProvider.GetBudgetSnapshot().largestDepartmentExpense, NumberType::Money).ToChar());
+		}
+		break;
+	case CityStatusType::YearToDateBudget:
+		std::snprintf(
+			buffer,
+			sizeof(buffer),
+			"YTD Income: %s, Expenses: %s",
+			GetUSEnglishNumberString(cityStatusProvider.GetBudgetSnapshot().yearToDateIncome, NumberType::Money).ToChar(),
+			GetUSEnglishNumberString(cityStatusProvider.GetBudgetSnapshot().yearToDateExpenses, NumberType::Money).ToChar());
+		break;
+	case CityStatusType::EstimatedBudget:
+		std::snprintf(
+			buffer,
+			sizeof(buffer),
+			"Est. Income: %s, Expenses: %s",
+			GetUSEnglishNumberString(cityStatusProvider.GetBudgetSnapshot().estimatedIncome, NumberType::Money).ToChar(),
+			GetUSEnglishNumberString(cityStatusProvider.GetBudgetSnapshot().estimatedExpenses, NumberType::Money).ToChar());
+		break;
+	case CityStatusType::OutstandingLoans:
+		std::snprintf(
+			buffer,
+			sizeof(buffer),
+			"Loans: %s (%s borrowed)",
+			GetUSEnglishNumberString(cityStatusProvider.GetBudgetSnapshot().loanCount).ToChar(),
+			GetUSEnglishNumberString(cityStatusProvider.GetBudgetSnapshot().totalBorrowed, NumberType::Money).ToChar());
+		break;
+	case CityStatusType::AverageAirPollution:
+		std::snprintf(
+			buffer,
+			sizeof(buffer),
+			"Avg. Air Pollution: %s",
+			GetUSEnglishNumberString(cityStatusProvider.GetAverageAirPollution()).ToChar());
+		break;
+	case CityStatusType::AverageWaterPollution:
+		std::snprintf(
+			buffer,
+			sizeof(buffer),
+			"Avg. Water Pollution: %s",
+			GetUSEnglishNumberString(cityStatusProvider.GetAverageWaterPollution()).ToChar());
+		break;
+	case CityStatusType::AveragePoliceCoverage:
+		std::snprintf(
+			buffer,
+			sizeof(buffer),
+			"Avg. Police Coverage: %s",
+			GetUSEnglishNumberString(cityStatusProvider.GetAveragePoliceCoverage()).ToChar());
+		break;
+	case CityStatusType::AverageAura:
+		std::snprintf(
+			buffer,
+			sizeof(buffer),
+			"Avg. Aura: %s",
+			GetUSEnglishNumberString(cityStatusProvider.GetAverageAura()).ToChar());
+		break;
+	case CityStatusType::CriminalCount:
+		std::snprintf(
+			buffer,
+			sizeof(buffer),
+			"Criminals: %s",
+			GetUSEnglishNumberString(cityStatusProvider.GetCriminalCount()).ToChar());
+		break;
 	}
 
-	activity.SetState(buffer);
+	return SetStateText(buffer);
 }
 
-void DiscordRichPresenceService::SetRegionStatusText()
+bool DiscordRichPresenceService::SetRegionStatusText()
 {
+	const StatusTemplate& statusTemplate = regionStatusTemplates[static_cast<size_t>(currentRegionStatus)];
+
+	if (!statusTemplate.IsEmpty())
+	{
+		std::array<StatusTemplateValue, static_cast<size_t>(RegionTemplateValue::Count)> values;
+		GetRegionTemplateValues(values.data());
+
+		char text[DiscordActivity::MaxStringLength];
+		statusTemplate.Render(values.data(), values.size(), text, sizeof(text));
+
+		return SetStateText(text);
+	}
+
 	char buffer[1024]{};
 
 	switch (currentRegionStatus)
@@ -446,9 +1126,99 @@ void DiscordRichPresenceService::SetRegionStatusText()
 			"Undeveloped Cities: %s",
 			GetUSEnglishNumberString(regionStatusProvider.GetUndevelopedCityCount()).ToChar());
 		break;
+	case RegionStatusType::LargestCity:
+		if (const RegionStatusProvider::RegionalCityInfo* pCity = regionStatusProvider.GetLargestCity())
+		{
+			std::snprintf(
+				buffer,
+				sizeof(buffer),
+				"Largest City: %s (%s)",
+				pCity->name.c_str(),
+				GetUSEnglishNumberString(pCity->population).ToChar());
+		}
+		else
+		{
+			std::snprintf(buffer, sizeof(buffer), "Largest City: None");
+		}
+		break;
+	case RegionStatusType::RichestCity:
+		if (const RegionStatusProvider::RegionalCityInfo* pCity = regionStatusProvider.GetRichestCity())
+		{
+			std::snprintf(
+				buffer,
+				sizeof(buffer),
+				"Richest City: %s (%s)",
+				pCity->name.c_str(),
+				GetUSEnglishNumberString(pCity->funds, NumberType::Money).ToChar());
+		}
+		else
+		{
+			std::snprintf(buffer, sizeof(buffer), "Richest City: None");
+		}
+		break;
+	case RegionStatusType::BorderingCities:
+		std::snprintf(
+			buffer,
+			sizeof(buffer),
+			"Bordering Cities: %s/%s",
+			GetUSEnglishNumberString(regionStatusProvider.GetBorderingCityCount()).ToChar(),
+			GetUSEnglishNumberString(regionStatusProvider.GetDevelopedCityCount()).ToChar());
+		break;
+	case RegionStatusType::StandaloneCities:
+		std::snprintf(
+			buffer,
+			sizeof(buffer),
+			"Standalone Cities: %s",
+			GetUSEnglishNumberString(regionStatusProvider.GetStandaloneCityCount()).ToChar());
+		break;
+	case RegionStatusType::DevelopedLand:
+		std::snprintf(
+			buffer,
+			sizeof(buffer),
+			"Developed Land: %u%%",
+			regionStatusProvider.GetDevelopedLandPercentage());
+		break;
+	case RegionStatusType::DensestCity:
+		if (const RegionStatusProvider::RegionalCityInfo* pCity = regionStatusProvider.GetDensestCity())
+		{
+			std::snprintf(
+				buffer,
+				sizeof(buffer),
+				"Densest City: %s (%s/sq km)",
+				pCity->name.c_str(),
+				GetUSEnglishNumberString(pCity->density).ToChar());
+		}
+		else
+		{
+			std::snprintf(buffer, sizeof(buffer), "Densest City: None");
+		}
+		break;
+	case RegionStatusType::CityClusters:
+		std::snprintf(
+			buffer,
+			sizeof(buffer),
+			"City Clusters: %s",
+			GetUSEnglishNumberString(regionStatusProvider.GetCityClusterCount()).ToChar());
+		break;
+	case RegionStatusType::LargestCityCluster:
+		std::snprintf(
+			buffer,
+			sizeof(buffer),
+			"Largest City Cluster: %s Cities",
+			GetUSEnglishNumberString(regionStatusProvider.GetLargestCityClusterSize()).ToChar());
+		break;
 	}
 
-	activity.SetState(buffer);
+	return SetStateText(buffer);
+}
+
+bool DiscordRichPresenceService::SetStateText(const char* text)
+{
+	const bool changed = std::strcmp(activity.GetState(), text) != 0;
+
+	activity.SetState(text);
+
+	return changed;
 }
 
 void DiscordRichPresenceService::SetCityViewPresence(cISC4City* pCity)
@@ -458,9 +1228,13 @@ void DiscordRichPresenceService::SetCityViewPresence(cISC4City* pCity)
 		UpdateCityName(pCity);
 		cityStatusProvider.SetupCityStatusData(pCity);
 		currentCityStatus = CityStatusType::MayorName;
+		UpdateCityStatusValues();
+		cityStatusScheduler.Reset(static_cast<size_t>(currentCityStatus), clock.GetSystemTime());
 		SetCityStatusText();
 
-		activity.GetTimestamps().SetStart(time(nullptr));
+		activity.SetStartTimestamp(clock.GetUnixTime());
+		simulationSpeed = 0;
+		simulationPaused = false;
 		view = DiscordView::EstablishedCity;
 		activityNeedsUpdate = true;
 	}
@@ -470,12 +1244,14 @@ void DiscordRichPresenceService::UpdateCityName(cISC4City* pCity)
 {
 	if (pCity)
 	{
-		cRZBaseString cityName;
+		cRZBaseString name;
+
+		pCity->GetCityName(name);
 
-		pCity->GetCityName(cityName);
+		cityName = Utf8Text::ToValidUtf8(name.ToChar(), name.Strlen());
 
 		std::string details("City: ");
-		details.append(cityName.ToChar(), cityName.Strlen());
+		details.append(cityName);
 
 		activity.SetDetails(details.c_str());
 	}
@@ -483,94 +1259,273 @@ void DiscordRichPresenceService::UpdateCityName(cISC4City* pCity)
 
 bool DiscordRichPresenceService::OnIdle(uint32_t unknown1)
 {
-	if (discord)
+	idleTimeBudget.BeginTick();
+
+	if (discordClient.Poll())
+	{
+		// Send the current activity after connecting or reconnecting to Discord.
+		updatePipeline.Reset();
+		activityNeedsUpdate = true;
+	}
+
+	const PresenceClock::SteadyTimePoint now = clock.GetSteadyTime();
+
+	// The tasks and the activity update are deferred to the next tick if
+	// reading from Discord used the tick's time budget.
+	if (idleTimeBudget.HasTimeRemaining())
+	{
+		taskScheduler.Tick(now);
+	}
+
+	if (discordClient.IsReady() && idleTimeBudget.HasTimeRemaining())
+	{
+		if (activityNeedsUpdate)
+		{
+			activityNeedsUpdate = false;
+			updatePipeline.Submit(activity);
+		}
+
+		updatePipeline.Send();
+	}
+
+	const bool wasDegraded = idleTimeBudget.IsDegraded();
+
+	idleTimeBudget.EndTick();
+
+	const bool degraded = idleTimeBudget.IsDegraded();
+
+	if (degraded != wasDegraded)
+	{
+		if (degraded)
+		{
+			LOG_INFO(
+				"The idle ticks are exceeding the {} us budget, reducing the status update rate.",
+				idleTimeBudget.GetBudget().count());
+		}
+		else
+		{
+			LOG_INFO(
+				"The idle ticks are within the {} us budget, restoring the status update rate.",
+				idleTimeBudget.GetBudget().count());
+		}
+	}
+
+	return true;
+}
+
+bool DiscordRichPresenceService::CanSelectStatus(void* pContext)
+{
+	DiscordRichPresenceService* pThis = static_cast<DiscordRichPresenceService*>(pContext);
+
+	// The status is only selected when the pipeline is able to send it, this
+	// allows a more significant change to replace the status while waiting.
+	return pThis->updatePipeline.CanSend();
+}
+
+void DiscordRichPresenceService::CityMonthlyValuesUpdated(void* pContext)
+{
+	static_cast<DiscordRichPresenceService*>(pContext)->taskScheduler.NotifyMessage(kSC4MessageSimNewMonth);
+}
+
+ScheduledTask DiscordRichPresenceService::CityValuesTask()
+{
+	for (;;)
 	{
-		if (discord->RunCallbacks() == discord::Result::Ok)
+		// Most of the city values only change once per month, so the scheduler's
+		// values are refreshed when the month changes instead of being polled.
+		co_await taskScheduler.WaitForMessage(kSC4MessageSimNewMonth);
+
+		if (view == DiscordView::EstablishedCity)
 		{
-			// The Discord API requires a minimum of 5 seconds between activity updates.
-			if (activityNeedsUpdate
-				&& (std::chrono::system_clock::now() - activityLastUpdateTime) > std::chrono::seconds(5))
+			UpdateCityStatusValues();
+		}
+
+		// The snapshot is published from the city data path, other plugins receive
+		// the new values even when Discord is not running or is busy.
+		PublishSnapshot();
+	}
+}
+
+ScheduledTask DiscordRichPresenceService::StatusSelectionTask()
+{
+	for (;;)
+	{
+		co_await taskScheduler.WaitUntil(CanSelectStatus, this);
+
+		const auto now = clock.GetSystemTime();
+
+		// The scheduler is checked at most once per second while waiting
+		// for a status that is worth sending.
+		std::chrono::seconds pollInterval(1);
+
+		if (view == DiscordView::EstablishedCity)
+		{
+			pollInterval = UpdateSimulationState();
+
+			// The values cannot change while the simulation is paused.
+			if (!simulationPaused)
 			{
-				activityNeedsUpdate = false;
-				activityLastUpdateTime = std::chrono::system_clock::now();
+				SelectNextCityStatus(now);
+			}
+		}
+		else if (view == DiscordView::Region)
+		{
+			SelectNextRegionStatus(now);
+		}
+
+		if (idleTimeBudget.IsDegraded())
+		{
+			// Check the values less often until the idle ticks are within the budget.
+			pollInterval *= 5;
+		}
+
+		co_await taskScheduler.Delay(pollInterval);
+	}
+}
+
+std::chrono::seconds DiscordRichPresenceService::UpdateSimulationState()
+{
+	bool paused = false;
+	int32_t speed = 0;
 
-				discord->ActivityManager().UpdateActivity(activity, DiscordAPICallback);
+	cISC4AppPtr pSC4App;
+
+	if (pSC4App)
+	{
+		cISC4City* pCity = pSC4App->GetCity();
+
+		if (pCity)
+		{
+			cISC4Simulator* pSimulator = pCity->GetSimulator();
+
+			if (pSimulator)
+			{
+				speed = pSimulator->GetSimSpeed();
+				paused = pSimulator->IsAnyPaused() || speed == PausedSimSpeed;
 			}
-			else
+		}
+	}
+
+	if (paused != simulationPaused)
+	{
+		simulationPaused = paused;
+
+		if (settings.GetShowPausedStatus())
+		{
+			// Restore the current status when the simulation resumes.
+			const bool changed = paused ? SetStateText("Paused") : SetCityStatusText();
+
+			if (changed)
 			{
-				if ((std::chrono::system_clock::now() - statusLastUpdateTime) > std::chrono::seconds(30))
-				{
-					statusLastUpdateTime = std::chrono::system_clock::now();
-
-					if (view == DiscordView::EstablishedCity)
-					{
-						switch (currentCityStatus)
-						{
-						case CityStatusType::MayorName:
-							currentCityStatus = CityStatusType::MayorRating;
-							break;
-						case CityStatusType::MayorRating:
-							currentCityStatus = CityStatusType::ResidentialPopulation;
-							break;
-						case CityStatusType::ResidentialPopulation:
-							currentCityStatus = CityStatusType::CommercialPopulation;
-							break;
-						case CityStatusType::CommercialPopulation:
-							currentCityStatus = CityStatusType::IndustrialPopulation;
-							break;
-						case CityStatusType::IndustrialPopulation:
-							currentCityStatus = CityStatusType::CityAgeInYears;
-							break;
-						case CityStatusType::CityAgeInYears:
-							currentCityStatus = CityStatusType::MonthlyNetIncome;
-							break;
-						case CityStatusType::MonthlyNetIncome:
-							currentCityStatus = CityStatusType::TotalFunds;
-							break;
-						case CityStatusType::TotalFunds:
-						default:
-							currentCityStatus = CityStatusType::MayorName;
-							break;
-						}
-						SetCityStatusText();
-
-						activityNeedsUpdate = true;
-					}
-					else if (view == DiscordView::Region)
-					{
-						switch (currentRegionStatus)
-						{
-						case RegionStatusType::TotalResidentialPopulation:
-							currentRegionStatus = RegionStatusType::TotalCommercialJobs;
-							break;
-						case RegionStatusType::TotalCommercialJobs:
-							currentRegionStatus = RegionStatusType::TotalIndustrialJobs;
-							break;
-						case RegionStatusType::TotalIndustrialJobs:
-							currentRegionStatus = RegionStatusType::TotalFunds;
-							break;
-						case RegionStatusType::TotalFunds:
-							currentRegionStatus = RegionStatusType::TotalCities;
-							break;
-						case RegionStatusType::TotalCities:
-							currentRegionStatus = RegionStatusType::DevelopedCityCount;
-							break;
-						case RegionStatusType::DevelopedCityCount:
-							currentRegionStatus = RegionStatusType::UndevelopedCityCount;
-							break;
-						case RegionStatusType::UndevelopedCityCount:
-						default:
-							currentRegionStatus = RegionStatusType::TotalResidentialPopulation;
-							break;
-						}
-						SetRegionStatusText();
-
-						activityNeedsUpdate = true;
-					}
-				}
+				activityNeedsUpdate = true;
 			}
 		}
 	}
 
-	return true;
+	if (speed != simulationSpeed)
+	{
+		simulationSpeed = speed;
+
+		cityStatusScheduler.SetRotationInterval(
+			speed == TurtleSimSpeed ? StatusRotationInterval * 2 : StatusRotationInterval);
+	}
+
+	if (paused)
+	{
+		return std::chrono::seconds(5);
+	}
+	else if (speed == TurtleSimSpeed)
+	{
+		return std::chrono::seconds(2);
+	}
+
+	return std::chrono::seconds(1);
+}
+
+bool DiscordRichPresenceService::GetSnapshot(cIDiscordPresenceSnapshot** ppSnapshot)
+{
+	if (ppSnapshot && pSnapshot)
+	{
+		pSnapshot->AddRef();
+		*ppSnapshot = pSnapshot;
+
+		return true;
+	}
+
+	return false;
+}
+
+void DiscordRichPresenceService::PublishSnapshot()
+{
+	DiscordPresenceSnapshotData data{};
+
+	switch (view)
+	{
+	case DiscordView::Region:
+		data.view = DiscordPresenceView::Region;
+		break;
+	case DiscordView::EstablishedCity:
+		data.view = DiscordPresenceView::EstablishedCity;
+		break;
+	case DiscordView::UnestablishedCity:
+		data.view = DiscordPresenceView::UnestablishedCity;
+		break;
+	case DiscordView::Unknown:
+	default:
+		data.view = DiscordPresenceView::None;
+		break;
+	}
+
+	data.regionName = regionName;
+	data.regionStats.totalResidentialPopulation = regionStatusProvider.GetTotalResidentialPopulation();
+	data.regionStats.totalCommercialJobs = regionStatusProvider.GetTotalCommercialJobs();
+	data.regionStats.totalIndustrialJobs = regionStatusProvider.GetTotalIndustrialJobs();
+	data.regionStats.totalFunds = regionStatusProvider.GetTotalFunds();
+	data.regionStats.developedCellCount = regionStatusProvider.GetDevelopedCellCount();
+	data.regionStats.totalCities = regionStatusProvider.GetTotalCities();
+	data.regionStats.developedCityCount = regionStatusProvider.GetDevelopedCityCount();
+	data.regionStats.undevelopedCityCount = regionStatusProvider.GetUndevelopedCityCount();
+	data.regionStats.borderingCityCount = regionStatusProvider.GetBorderingCityCount();
+	data.regionStats.standaloneCityCount = regionStatusProvider.GetStandaloneCityCount();
+	data.regionStats.developedLandPercentage = regionStatusProvider.GetDevelopedLandPercentage();
+	data.regionStats.cityClusterCount = regionStatusProvider.GetCityClusterCount();
+	data.regionStats.largestCityClusterSize = regionStatusProvider.GetLargestCityClusterSize();
+
+	if (data.view == DiscordPresenceView::EstablishedCity)
+	{
+		data.cityName = cityName;
+		data.mayorName = cityStatusProvider.GetMayorName().ToChar();
+		data.cityStats.totalFunds = cityStatusProvider.GetTotalFunds();
+		data.cityStats.residentialPopulation = cityStatusProvider.GetResidentalPopulation();
+		data.cityStats.commercialPopulation = cityStatusProvider.GetCommercialPopulation();
+		data.cityStats.industrialPopulation = cityStatusProvider.GetIndustrialPopulation();
+		data.cityStats.mayorRating = cityStatusProvider.GetMayorRating();
+		data.cityStats.cityAgeInYears = cityStatusProvider.GetCityAgeInYears();
+		data.cityStats.monthlyNetIncome = cityStatusProvider.GetMonthlyNetIncome();
+		data.cityStats.averageAirPollution = cityStatusProvider.GetAverageAirPollution();
+		data.cityStats.averageWaterPollution = cityStatusProvider.GetAverageWaterPollution();
+		data.cityStats.averagePoliceCoverage = cityStatusProvider.GetAveragePoliceCoverage();
+		data.cityStats.averageAura = cityStatusProvider.GetAverageAura();
+		data.cityStats.lotCount = cityStatusProvider.GetLotCount();
+		data.cityStats.buildingCount = cityStatusProvider.GetBuildingCount();
+		data.cityStats.landmarkCount = cityStatusProvider.GetLandmarkCount();
+		data.cityStats.criminalCount = cityStatusProvider.GetCriminalCount();
+	}
+
+	// The snapshot is only replaced when a value has changed, so readers can use
+	// the version to skip the snapshots that they have already seen.
+	if (pSnapshot && pSnapshot->GetData() == data)
+	{
+		return;
+	}
+
+	DiscordPresenceSnapshot* pNewSnapshot = new DiscordPresenceSnapshot(++snapshotVersion, data);
+	pNewSnapshot->AddRef();
+
+	if (pSnapshot)
+	{
+		pSnapshot->Release();
+	}
+
+	pSnapshot = pNewSnapshot;
 }
@@ -14,21 +14,34 @@
 #include "ServiceBase.h"
 #include "CityStatusProvider.h"
 #include "RegionStatusProvider.h"
+#include "Settings.h"
+#include "StatusScheduler.h"
+#include "ActivityUpdatePipeline.h"
+#include "TaskScheduler.h"
+#include "IdleTimeBudget.h"
+#include "PresenceClock.h"
+#include "StatusTemplate.h"
+#include "DiscordActivity.h"
+#include "DiscordPresenceSnapshot.h"
+#include "DiscordIpcClient.h"
 #include "cIGZMessageTarget2.h"
-#include "discord-game-sdk/discord.h"
+#include <array>
 #include <atomic>
 #include <chrono>
-#include <memory>
+#include <string>
 
 class cIGZLanguageUtility;
 class cIGZMessage2Standard;
 class cISC4City;
 class cISC4Region;
 
-class DiscordRichPresenceService final : public ServiceBase, private cIGZMessageTarget2
+class DiscordRichPresenceService final
+	: public ServiceBase,
+	  private cIGZMessageTarget2,
+	  private cIDiscordPresenceStats
 {
 public:
-	DiscordRichPresenceService();
+	DiscordRichPresenceService(const Settings& settings, const PresenceClock& clock);
 
 	bool QueryInterface(uint32_t riid, void** ppvObj) override;
 	uint32_t AddRef() override;
@@ -45,9 +58,25 @@ private:
 		ResidentialPopulation,
 		CommercialPopulation,
 		IndustrialPopulation,
+		ResidentialWealthPopulation,
+		CommercialSectorJobs,
+		IndustrialSectorJobs,
+		LotCount,
+		BuildingCount,
+		LandmarkCount,
 		CityAgeInYears,
 		MonthlyNetIncome,
 		TotalFunds,
+		LargestExpense,
+		YearToDateBudget,
+		EstimatedBudget,
+		OutstandingLoans,
+		AverageAirPollution,
+		AverageWaterPollution,
+		AveragePoliceCoverage,
+		AverageAura,
+		CriminalCount,
+		Count
 	};
 
 	enum class RegionStatusType
@@ -59,6 +88,15 @@ private:
 		TotalCities,
 		DevelopedCityCount,
 		UndevelopedCityCount,
+		LargestCity,
+		RichestCity,
+		BorderingCities,
+		StandaloneCities,
+		DevelopedLand,
+		DensestCity,
+		CityClusters,
+		LargestCityCluster,
+		Count
 	};
 
 	enum class DiscordView : int32_t
@@ -87,9 +125,29 @@ private:
 
 	void PostRegionInit();
 
-	void SetCityStatusText();
+	double GetCityStatusValue(CityStatusType type) const;
 
-	void SetRegionStatusText();
+	double GetRegionStatusValue(RegionStatusType type) const;
+
+	void UpdateCityStatusValues();
+
+	void UpdateRegionStatusValues();
+
+	void SelectNextCityStatus(StatusScheduler::TimePoint now);
+
+	void SelectNextRegionStatus(StatusScheduler::TimePoint now);
+
+	void CompileStatusTemplates();
+
+	void GetCityTemplateValues(StatusTemplateValue* values) const;
+
+	void GetRegionTemplateValues(StatusTemplateValue* values) const;
+
+	bool SetCityStatusText();
+
+	bool SetRegionStatusText();
+
+	bool SetStateText(const char* text);
 
 	void SetCityViewPresence(cISC4City* pCity);
 
@@ -97,16 +155,43 @@ private:
 
 	bool OnIdle(uint32_t unknown1) override;
 
-	std::unique_ptr<discord::Core> discord;
-	discord::Activity activity;
-	std::chrono::time_point<std::chrono::system_clock> activityLastUpdateTime;
-	std::chrono::time_point<std::chrono::system_clock> statusLastUpdateTime;
+	static bool CanSelectStatus(void* pContext);
+
+	static void CityMonthlyValuesUpdated(void* pContext);
+
+	std::chrono::seconds UpdateSimulationState();
+
+	ScheduledTask StatusSelectionTask();
+
+	ScheduledTask CityValuesTask();
+
+	bool GetSnapshot(cIDiscordPresenceSnapshot** ppSnapshot) override;
+
+	void PublishSnapshot();
+
+	const PresenceClock& clock;
+	DiscordIpcClient discordClient;
+	ActivityUpdatePipeline updatePipeline;
+	DiscordActivity activity;
 	std::atomic_bool activityNeedsUpdate;
 	CityStatusProvider cityStatusProvider;
 	RegionStatusProvider regionStatusProvider;
+	const Settings& settings;
+	StatusScheduler cityStatusScheduler;
+	StatusScheduler regionStatusScheduler;
 	CityStatusType currentCityStatus;
 	RegionStatusType currentRegionStatus;
 	std::atomic<DiscordView> view;
 	cIGZLanguageUtility* pLanguageUtility;
+	TaskScheduler taskScheduler;
+	IdleTimeBudget idleTimeBudget;
+	int32_t simulationSpeed;
+	bool simulationPaused;
+	std::array<StatusTemplate, static_cast<size_t>(CityStatusType::Count)> cityStatusTemplates;
+	std::array<StatusTemplate, static_cast<size_t>(RegionStatusType::Count)> regionStatusTemplates;
+	std::string cityName;
+	std::string regionName;
+	DiscordPresenceSnapshot* pSnapshot;
+	uint32_t snapshotVersion;
 };
 
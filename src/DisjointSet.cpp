@@ -0,0 +1,93 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-discord-rich-presence, a DLL Plugin for
+// SimCity 4 that implements Discord rich presence support.
+//
+// Copyright (c) 2024 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#include "DisjointSet.h"
+#include <utility>
+
+DisjointSet::DisjointSet()
+	: parents(),
+	  sizes()
+{
+}
+
+void DisjointSet::Reset(uint32_t elementCount)
+{
+	parents.resize(elementCount);
+	sizes.assign(elementCount, 1);
+
+	for (uint32_t i = 0; i < elementCount; i++)
+	{
+		parents[i] = i;
+	}
+}
+
+uint32_t DisjointSet::Add()
+{
+	const uint32_t element = static_cast<uint32_t>(parents.size());
+
+	parents.push_back(element);
+	sizes.push_back(1);
+
+	return element;
+}
+
+uint32_t DisjointSet::Find(uint32_t element)
+{
+	uint32_t root = element;
+
+	while (parents[root] != root)
+	{
+		root = parents[root];
+	}
+
+	// Point every element on the path directly at the root.
+	while (parents[element] != root)
+	{
+		const uint32_t next = parents[element];
+		parents[element] = root;
+		element = next;
+	}
+
+	return root;
+}
+
+bool DisjointSet::Union(uint32_t a, uint32_t b)
+{
+	uint32_t rootA = Find(a);
+	uint32_t rootB = Find(b);
+
+	if (rootA == rootB)
+	{
+		return false;
+	}
+
+	// Attach the smaller set to the larger one to keep the trees shallow.
+	if (sizes[rootA] < sizes[rootB])
+	{
+		std::swap(rootA, rootB);
+	}
+
+	parents[rootB] = rootA;
+	sizes[rootA] += sizes[rootB];
+
+	return true;
+}
+
+uint32_t DisjointSet::GetSetSize(uint32_t element)
+{
+	return sizes[Find(element)];
+}
+
+uint32_t DisjointSet::GetElementCount() const
+{
+	return static_cast<uint32_t>(parents.size());
+}
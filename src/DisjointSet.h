@@ -0,0 +1,43 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-discord-rich-presence, a DLL Plugin for
+// SimCity 4 that implements Discord rich presence support.
+//
+// Copyright (c) 2024 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// A union-find structure that groups elements into disjoint sets.
+// Uses union by size and path compression, so a sequence of operations runs
+// in nearly linear time.
+class DisjointSet
+{
+public:
+	DisjointSet();
+
+	// Places each of the elements in its own set.
+	void Reset(uint32_t elementCount);
+
+	// Adds an element in its own set and returns it.
+	uint32_t Add();
+
+	uint32_t Find(uint32_t element);
+
+	// Returns true if the elements were in different sets.
+	bool Union(uint32_t a, uint32_t b);
+
+	uint32_t GetSetSize(uint32_t element);
+
+	uint32_t GetElementCount() const;
+
+private:
+	std::vector<uint32_t> parents;
+	std::vector<uint32_t> sizes;
+};
@@ -0,0 +1,398 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-discord-rich-presence, a DLL Plugin for
+// SimCity 4 that implements Discord rich presence support.
+//
+// Copyright (c) 2024 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#include "FlightRecorder.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <vector>
+#include <Windows.h>
+
+// The file starts with a Header that is followed by the ring buffer.
+//
+// Each event is stored as a RecordHeader, the message text and a uint32_t
+// that repeats the record size. The trailing size allows the decoder to walk
+// backwards from the newest event and stop at the first event that has been
+// partially overwritten.
+// A record is never split at the end of the ring, when it does not fit the
+// writer starts again at the beginning and stores the end of the valid data.
+struct FlightRecorder::Header
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t capacity;
+	uint32_t sessionOpen;
+	int64_t ticksPerSecond;
+	int64_t startTicks;
+	int64_t startUnixTimeMs;
+	uint64_t nextSequence;
+	uint32_t writeOffset;
+	uint32_t wrapEnd;
+	uint32_t hasWrapped;
+	uint32_t reserved;
+};
+
+namespace
+{
+	constexpr uint32_t FileMagic = 0x52464353; // SCFR
+	constexpr uint32_t FileVersion = 2;
+	constexpr uint32_t RecordMagic = 0xF17E;
+	constexpr uint32_t RecordAlignment = 8;
+	constexpr uint32_t MinimumCapacity = 4096;
+	constexpr size_t MaxMessageLength = 1024;
+
+	struct RecordHeader
+	{
+		uint16_t magic;
+		uint8_t level;
+		uint8_t reserved;
+		uint32_t size;
+		uint64_t sequence;
+		int64_t ticks;
+		uint32_t messageLength;
+		uint32_t reserved2;
+	};
+
+	constexpr uint32_t RecordOverhead = sizeof(RecordHeader) + sizeof(uint32_t);
+
+	uint32_t AlignRecordSize(size_t size)
+	{
+		return static_cast<uint32_t>((size + RecordAlignment - 1) & ~static_cast<size_t>(RecordAlignment - 1));
+	}
+
+	int64_t GetTicks()
+	{
+		LARGE_INTEGER value{};
+		QueryPerformanceCounter(&value);
+
+		return value.QuadPart;
+	}
+
+	int64_t GetTicksPerSecond()
+	{
+		LARGE_INTEGER value{};
+		QueryPerformanceFrequency(&value);
+
+		return value.QuadPart;
+	}
+
+	const char* GetLevelName(uint8_t level)
+	{
+		switch (level)
+		{
+		case 0:
+			return "Error";
+		case 1:
+			return "Info";
+		case 2:
+			return "Debug";
+		case 3:
+			return "Trace";
+		default:
+			return "Unknown";
+		}
+	}
+
+	bool ReadFileContents(const std::filesystem::path& path, std::vector<uint8_t>& contents)
+	{
+		std::ifstream stream(path, std::ifstream::binary);
+
+		if (!stream)
+		{
+			return false;
+		}
+
+		stream.seekg(0, std::ifstream::end);
+		const std::streamoff size = stream.tellg();
+		stream.seekg(0, std::ifstream::beg);
+
+		if (size <= 0)
+		{
+			return false;
+		}
+
+		contents.resize(static_cast<size_t>(size));
+		stream.read(reinterpret_cast<char*>(contents.data()), size);
+
+		return static_cast<bool>(stream);
+	}
+}
+
+FlightRecorder::FlightRecorder()
+	: file(INVALID_HANDLE_VALUE),
+	  mapping(nullptr),
+	  view(nullptr)
+{
+}
+
+FlightRecorder::~FlightRecorder()
+{
+	Close();
+}
+
+bool FlightRecorder::Open(const std::filesystem::path& path, uint32_t capacityInBytes)
+{
+	Close();
+
+	const uint32_t capacity = AlignRecordSize(capacityInBytes < MinimumCapacity ? MinimumCapacity : capacityInBytes);
+	const DWORD fileSize = static_cast<DWORD>(sizeof(Header) + capacity);
+
+	file = CreateFileW(
+		path.c_str(),
+		GENERIC_READ | GENERIC_WRITE,
+		FILE_SHARE_READ,
+		nullptr,
+		CREATE_ALWAYS,
+		FILE_ATTRIBUTE_NORMAL,
+		nullptr);
+
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	mapping = CreateFileMappingW(file, nullptr, PAGE_READWRITE, 0, fileSize, nullptr);
+
+	if (!mapping)
+	{
+		Close();
+		return false;
+	}
+
+	view = static_cast<uint8_t*>(MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, fileSize));
+
+	if (!view)
+	{
+		Close();
+		return false;
+	}
+
+	Header* header = GetHeader();
+	std::memset(header, 0, sizeof(Header));
+
+	header->magic = FileMagic;
+	header->version = FileVersion;
+	header->capacity = capacity;
+	header->sessionOpen = 1;
+	header->ticksPerSecond = GetTicksPerSecond();
+	header->startTicks = GetTicks();
+	header->startUnixTimeMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+		std::chrono::system_clock::now().time_since_epoch()).count();
+	header->nextSequence = 1;
+
+	return true;
+}
+
+void FlightRecorder::Close()
+{
+	if (view)
+	{
+		GetHeader()->sessionOpen = 0;
+
+		UnmapViewOfFile(view);
+		view = nullptr;
+	}
+
+	if (mapping)
+	{
+		CloseHandle(mapping);
+		mapping = nullptr;
+	}
+
+	if (file != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(file);
+		file = INVALID_HANDLE_VALUE;
+	}
+}
+
+bool FlightRecorder::IsOpen() const
+{
+	return view != nullptr;
+}
+
+void FlightRecorder::Write(int32_t level, const char* message, size_t length)
+{
+	if (!view)
+	{
+		return;
+	}
+
+	Header* header = GetHeader();
+
+	const size_t messageLength = length < MaxMessageLength ? length : MaxMessageLength;
+	const uint32_t recordSize = AlignRecordSize(RecordOverhead + messageLength);
+
+	uint32_t offset = header->writeOffset;
+
+	if (recordSize > (header->capacity - offset))
+	{
+		header->wrapEnd = offset;
+		header->hasWrapped = 1;
+		offset = 0;
+	}
+
+	uint8_t* record = view + sizeof(Header) + offset;
+
+	RecordHeader recordHeader{};
+	recordHeader.magic = RecordMagic;
+	recordHeader.level = static_cast<uint8_t>(level);
+	recordHeader.size = recordSize;
+	recordHeader.sequence = header->nextSequence;
+	recordHeader.ticks = GetTicks();
+	recordHeader.messageLength = static_cast<uint32_t>(messageLength);
+
+	std::memcpy(record, &recordHeader, sizeof(RecordHeader));
+	std::memcpy(record + sizeof(RecordHeader), message, messageLength);
+	std::memcpy(record + recordSize - sizeof(uint32_t), &recordSize, sizeof(uint32_t));
+
+	// The write offset is updated last, a record that was being written
+	// when the process died is ignored by the decoder.
+	header->nextSequence++;
+	header->writeOffset = offset + recordSize;
+}
+
+bool FlightRecorder::WasSessionInterrupted(const std::filesystem::path& path)
+{
+	std::ifstream stream(path, std::ifstream::binary);
+
+	Header header{};
+
+	if (stream && stream.read(reinterpret_cast<char*>(&header), sizeof(Header)))
+	{
+		return header.magic == FileMagic && header.version == FileVersion && header.sessionOpen != 0;
+	}
+
+	return false;
+}
+
+bool FlightRecorder::Decode(const std::filesystem::path& path, std::ostream& output)
+{
+	std::vector<uint8_t> contents;
+
+	if (!ReadFileContents(path, contents) || contents.size() < sizeof(Header))
+	{
+		return false;
+	}
+
+	Header header{};
+	std::memcpy(&header, contents.data(), sizeof(Header));
+
+	if (header.magic != FileMagic
+		|| header.version != FileVersion
+		|| header.ticksPerSecond <= 0
+		|| header.capacity > (contents.size() - sizeof(Header))
+		|| header.writeOffset > header.capacity
+		|| header.wrapEnd > header.capacity)
+	{
+		return false;
+	}
+
+	const uint8_t* ring = contents.data() + sizeof(Header);
+
+	// Walk backwards from the newest record, collecting the record offsets.
+	std::vector<uint32_t> recordOffsets;
+
+	uint32_t position = header.writeOffset;
+	uint64_t expectedSequence = header.nextSequence - 1;
+	bool crossedWrap = false;
+
+	while (expectedSequence > 0)
+	{
+		if (position == 0)
+		{
+			if (!header.hasWrapped || crossedWrap)
+			{
+				break;
+			}
+
+			position = header.wrapEnd;
+			crossedWrap = true;
+			continue;
+		}
+
+		if (position < RecordOverhead)
+		{
+			break;
+		}
+
+		uint32_t recordSize = 0;
+		std::memcpy(&recordSize, ring + position - sizeof(uint32_t), sizeof(uint32_t));
+
+		if (recordSize < RecordOverhead || recordSize > position || (recordSize % RecordAlignment) != 0)
+		{
+			break;
+		}
+
+		const uint32_t start = position - recordSize;
+
+		// After wrapping, the records that start before the newest write offset
+		// have been partially overwritten.
+		if (crossedWrap && start < header.writeOffset)
+		{
+			break;
+		}
+
+		RecordHeader recordHeader{};
+		std::memcpy(&recordHeader, ring + start, sizeof(RecordHeader));
+
+		if (recordHeader.magic != RecordMagic
+			|| recordHeader.size != recordSize
+			|| recordHeader.sequence != expectedSequence
+			|| recordHeader.messageLength > (recordSize - RecordOverhead))
+		{
+			break;
+		}
+
+		recordOffsets.push_back(start);
+		position = start;
+		expectedSequence--;
+	}
+
+	for (auto it = recordOffsets.rbegin(); it != recordOffsets.rend(); ++it)
+	{
+		RecordHeader recordHeader{};
+		std::memcpy(&recordHeader, ring + *it, sizeof(RecordHeader));
+
+		const int64_t elapsedMs = ((recordHeader.ticks - header.startTicks) * 1000) / header.ticksPerSecond;
+		const std::chrono::system_clock::time_point time{ std::chrono::milliseconds(header.startUnixTimeMs + elapsedMs) };
+		const std::time_t seconds = std::chrono::system_clock::to_time_t(time);
+
+		std::tm localTime{};
+		localtime_s(&localTime, &seconds);
+
+		char timeStamp[64]{};
+		std::strftime(timeStamp, sizeof(timeStamp), "%Y-%m-%d %H:%M:%S", &localTime);
+
+		char prefix[128]{};
+		std::snprintf(
+			prefix,
+			sizeof(prefix),
+			"%s.%03d [%s] ",
+			timeStamp,
+			static_cast<int>((header.startUnixTimeMs + elapsedMs) % 1000),
+			GetLevelName(recordHeader.level));
+
+		output << prefix;
+		output.write(reinterpret_cast<const char*>(ring + *it + sizeof(RecordHeader)), recordHeader.messageLength);
+		output << '\n';
+	}
+
+	return true;
+}
+
+FlightRecorder::Header* FlightRecorder::GetHeader() const
+{
+	return reinterpret_cast<Header*>(view);
+}
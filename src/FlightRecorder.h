@@ -0,0 +1,54 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-discord-rich-presence, a DLL Plugin for
+// SimCity 4 that implements Discord rich presence support.
+//
+// Copyright (c) 2024 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <ostream>
+
+// Records the most recent log events in a fixed-size memory-mapped ring file.
+//
+// Writing an event only copies it into the mapped view, the OS writes the dirty
+// pages to the file even if SC4 crashes, so the file always contains the events
+// that lead up to the crash without the cost of flushing the log file.
+class FlightRecorder
+{
+public:
+	FlightRecorder();
+	~FlightRecorder();
+
+	FlightRecorder(const FlightRecorder&) = delete;
+	FlightRecorder& operator=(const FlightRecorder&) = delete;
+
+	bool Open(const std::filesystem::path& path, uint32_t capacityInBytes);
+	void Close();
+
+	bool IsOpen() const;
+
+	void Write(int32_t level, const char* message, size_t length);
+
+	// Returns true if the file was written by a session that did not close the recorder,
+	// e.g. because the game crashed.
+	static bool WasSessionInterrupted(const std::filesystem::path& path);
+
+	// Writes the events in the file to the stream as text, the oldest event is written first.
+	static bool Decode(const std::filesystem::path& path, std::ostream& output);
+
+private:
+	struct Header;
+
+	Header* GetHeader() const;
+
+	void* file;
+	void* mapping;
+	uint8_t* view;
+};
@@ -0,0 +1,41 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-discord-rich-presence, a DLL Plugin for
+// SimCity 4 that implements Discord rich presence support.
+//
+// Copyright (c) 2024 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include "cISC4SimGrid.h"
+#include <cstdint>
+
+namespace GridStatistics
+{
+	// Computes the average tract value of the whole grid.
+	// The layout of the grid's raw data is not documented, so the average is
+	// read through the grid's own rectangle averaging method.
+	template <typename T>
+	bool GetAverageTractValue(cISC4SimGrid<T>* pGrid, int32_t& average)
+	{
+		average = 0;
+
+		if (pGrid)
+		{
+			const int32_t tractCountX = pGrid->GetTractCountX();
+			const int32_t tractCountZ = pGrid->GetTractCountZ();
+
+			if (tractCountX > 0 && tractCountZ > 0)
+			{
+				average = pGrid->GetAverageValueInTractRect(0, 0, tractCountX - 1, tractCountZ - 1);
+				return true;
+			}
+		}
+
+		return false;
+	}
+}
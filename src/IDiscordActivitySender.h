@@ -0,0 +1,27 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-discord-rich-presence, a DLL Plugin for
+// SimCity 4 that implements Discord rich presence support.
+//
+// Copyright (c) 2024 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include "DiscordActivity.h"
+#include <cstdint>
+
+// The connection that the ActivityUpdatePipeline sends the activity updates through.
+class IDiscordActivitySender
+{
+public:
+	virtual ~IDiscordActivitySender() = default;
+
+	virtual bool IsReady() const = 0;
+
+	// Returns the request id, or 0 if the request could not be sent.
+	virtual uint64_t UpdateActivity(const DiscordActivity& activity) = 0;
+};
@@ -0,0 +1,88 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-discord-rich-presence, a DLL Plugin for
+// SimCity 4 that implements Discord rich presence support.
+//
+// Copyright (c) 2024 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#include "IdleTimeBudget.h"
+
+namespace
+{
+	// The over budget ticks are counted in windows of this many ticks.
+	constexpr uint32_t TicksPerWindow = 100;
+
+	// The plugin switches to the degraded mode when a window has at least this many
+	// over budget ticks, and switches back after a window without any.
+	constexpr uint32_t DegradedOverrunThreshold = 10;
+}
+
+IdleTimeBudget::IdleTimeBudget(std::chrono::microseconds budget, const PresenceClock& clock)
+	: budget(budget),
+	  clock(clock),
+	  tickStartTime(),
+	  windowTickCount(0),
+	  windowOverrunCount(0),
+	  degraded(false)
+{
+}
+
+std::chrono::microseconds IdleTimeBudget::GetBudget() const
+{
+	return budget;
+}
+
+void IdleTimeBudget::SetBudget(std::chrono::microseconds value)
+{
+	budget = value;
+}
+
+void IdleTimeBudget::BeginTick()
+{
+	tickStartTime = clock.GetSteadyTime();
+}
+
+bool IdleTimeBudget::HasTimeRemaining() const
+{
+	return budget.count() == 0 || (clock.GetSteadyTime() - tickStartTime) < budget;
+}
+
+void IdleTimeBudget::EndTick()
+{
+	if (budget.count() == 0)
+	{
+		return;
+	}
+
+	if ((clock.GetSteadyTime() - tickStartTime) >= budget)
+	{
+		windowOverrunCount++;
+	}
+
+	windowTickCount++;
+
+	if (windowTickCount == TicksPerWindow)
+	{
+		if (!degraded && windowOverrunCount >= DegradedOverrunThreshold)
+		{
+			degraded = true;
+		}
+		else if (degraded && windowOverrunCount == 0)
+		{
+			degraded = false;
+		}
+
+		windowTickCount = 0;
+		windowOverrunCount = 0;
+	}
+}
+
+bool IdleTimeBudget::IsDegraded() const
+{
+	return degraded;
+}
@@ -0,0 +1,49 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-discord-rich-presence, a DLL Plugin for
+// SimCity 4 that implements Discord rich presence support.
+//
+// Copyright (c) 2024 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include "PresenceClock.h"
+#include <chrono>
+#include <cstdint>
+
+// Limits the time that the plugin spends in a single OnIdle call.
+//
+// The work that is optional for a tick checks HasTimeRemaining and is deferred
+// to a later tick if the budget has been used.
+// If the budget is exceeded too often, the plugin switches to a degraded mode
+// that does less work until the ticks are within the budget again.
+class IdleTimeBudget
+{
+public:
+	// A budget of zero disables the limit.
+	IdleTimeBudget(std::chrono::microseconds budget, const PresenceClock& clock);
+
+	std::chrono::microseconds GetBudget() const;
+
+	void SetBudget(std::chrono::microseconds budget);
+
+	void BeginTick();
+
+	bool HasTimeRemaining() const;
+
+	void EndTick();
+
+	bool IsDegraded() const;
+
+private:
+	std::chrono::microseconds budget;
+	const PresenceClock& clock;
+	PresenceClock::SteadyTimePoint tickStartTime;
+	uint32_t windowTickCount;
+	uint32_t windowOverrunCount;
+	bool degraded;
+};
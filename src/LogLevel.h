@@ -0,0 +1,42 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-discord-rich-presence, a DLL Plugin for
+// SimCity 4 that implements Discord rich presence support.
+//
+// Copyright (c) 2024 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <cstdint>
+
+// The log levels in order of increasing verbosity, each level also
+// writes the messages of the levels below it.
+enum class LogLevel : int32_t
+{
+	Error = 0,
+	Info = 1,
+	Debug = 2,
+	Trace = 3
+};
+
+// The level that the plugin uses for its log file.
+constexpr LogLevel DefaultLogLevel = LogLevel::Info;
+
+constexpr bool IsLogLevelEnabled(LogLevel currentLevel, LogLevel messageLevel)
+{
+	return static_cast<int32_t>(messageLevel) <= static_cast<int32_t>(currentLevel);
+}
+
+// The highest log level that is compiled into the plugin, the logging macros
+// for the levels above this value compile to nothing.
+#ifndef LOG_MAX_COMPILED_LEVEL
+#ifdef _DEBUG
+#define LOG_MAX_COMPILED_LEVEL 3 // LogLevel::Trace
+#else
+#define LOG_MAX_COMPILED_LEVEL 1 // LogLevel::Info
+#endif // _DEBUG
+#endif // LOG_MAX_COMPILED_LEVEL
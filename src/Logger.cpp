@@ -11,6 +11,7 @@
 ////////////////////////////////////////////////////////////////////////
 
 #include "Logger.h"
+#include <cstring>
 #include <Windows.h>
 
 namespace
@@ -86,7 +87,7 @@ void Logger::Init(std::filesystem::path logFilePath, LogLevel level, bool includ
 
 bool Logger::IsEnabled(LogLevel level) const
 {
-	return logLevel >= level;
+	return IsLogLevelEnabled(logLevel, level);
 }
 
 void Logger::SetLogLevel(LogLevel level)
@@ -94,6 +95,21 @@ void Logger::SetLogLevel(LogLevel level)
 	logLevel = level;
 }
 
+bool Logger::EnableFlightRecorder(const std::filesystem::path& path, uint32_t capacityInBytes)
+{
+	return flightRecorder.Open(path, capacityInBytes);
+}
+
+void Logger::DisableFlightRecorder()
+{
+	flightRecorder.Close();
+
+	if (initialized && logFile)
+	{
+		logFile.flush();
+	}
+}
+
 void Logger::WriteLogFileHeader(const char* const text)
 {
 	if (initialized && logFile)
@@ -109,7 +125,7 @@ void Logger::WriteLine(LogLevel level, const char* const message)
 		return;
 	}
 
-	WriteLineCore(message);
+	WriteLineCore(level, message, std::strlen(message));
 }
 
 void Logger::WriteLineFormatted(LogLevel level, const char* const format, ...)
@@ -125,59 +141,69 @@ void Logger::WriteLineFormatted(LogLevel level, const char* const format, ...)
 	va_list argsCopy;
 	va_copy(argsCopy, args);
 
-	int formattedStringLength = std::vsnprintf(nullptr, 0, format, argsCopy);
+	std::span<char> buffer = GetThreadFormatBuffer();
 
-	va_end(argsCopy);
+	// Most messages fit in the thread buffer, so they are formatted in a single pass.
+	// The length that vsnprintf returns is only used to allocate a larger buffer
+	// when the message was truncated.
+	const int formattedStringLength = std::vsnprintf(buffer.data(), buffer.size(), format, args);
 
 	if (formattedStringLength > 0)
 	{
-		size_t formattedStringLengthWithNull = static_cast<size_t>(formattedStringLength) + 1;
+		const size_t formattedStringLengthWithNull = static_cast<size_t>(formattedStringLength) + 1;
 
-		constexpr size_t stackBufferSize = 1024;
-
-		if (formattedStringLengthWithNull >= stackBufferSize)
+		if (formattedStringLengthWithNull > buffer.size())
 		{
-			std::unique_ptr<char[]> buffer = std::make_unique_for_overwrite<char[]>(formattedStringLengthWithNull);
+			std::unique_ptr<char[]> largeBuffer = std::make_unique_for_overwrite<char[]>(formattedStringLengthWithNull);
 
-			std::vsnprintf(buffer.get(), formattedStringLengthWithNull, format, args);
+			std::vsnprintf(largeBuffer.get(), formattedStringLengthWithNull, format, argsCopy);
 
-			WriteLineCore(buffer.get());
+			WriteLineCore(level, largeBuffer.get(), static_cast<size_t>(formattedStringLength));
 		}
 		else
 		{
-			char buffer[stackBufferSize]{};
-
-			std::vsnprintf(buffer, stackBufferSize, format, args);
-
-			WriteLineCore(buffer);
+			WriteLineCore(level, buffer.data(), static_cast<size_t>(formattedStringLength));
 		}
 	}
 
+	va_end(argsCopy);
 	va_end(args);
 }
 
-void Logger::WriteLineCore(const char* const message)
+std::span<char> Logger::GetThreadFormatBuffer()
+{
+	thread_local char buffer[1024];
+
+	return std::span<char>(buffer);
+}
+
+void Logger::WriteLineCore(LogLevel level, const char* const message, size_t length)
 {
 	if (initialized && logFile)
 	{
+		std::string timeStamp;
+
 		if (writeTimeStamp)
 		{
-			std::string timeStamp = GetTimeStamp();
+			timeStamp = GetTimeStamp();
+		}
 
 #ifdef _DEBUG
-			PrintLineToDebugOutput(timeStamp.c_str(), message);
+		PrintLineToDebugOutput(writeTimeStamp ? timeStamp.c_str() : nullptr, message);
 #endif // _DEBUG
 
-			logFile << timeStamp << message << std::endl;
+		logFile << timeStamp << message;
+
+		if (flightRecorder.IsOpen())
+		{
+			// The flight recorder preserves the line if the game crashes,
+			// so the log file does not need to be flushed.
+			flightRecorder.Write(static_cast<int32_t>(level), message, length);
+			logFile << '\n';
 		}
 		else
 		{
-#ifdef _DEBUG
-			PrintLineToDebugOutput(nullptr, message);
-#endif // _DEBUG
-
-			logFile << message << std::endl;
-
+			logFile << std::endl;
 		}
 	}
 }
\ No newline at end of file
@@ -11,16 +11,18 @@
 ////////////////////////////////////////////////////////////////////////
 
 #pragma once
+#include "FlightRecorder.h"
+#include "LogLevel.h"
 #include <filesystem>
+#include <format>
 #include <fstream>
+#include <span>
 
-enum class LogLevel : int32_t
-{
-	Info = 0,
-	Error = 1,
-	Debug = 2,
-	Trace = 3
-};
+#ifdef _MSC_VER
+#include <sal.h>
+#else
+#define _Printf_format_string_
+#endif // _MSC_VER
 
 class Logger
 {
@@ -34,22 +36,72 @@ public:
 
 	void SetLogLevel(LogLevel level);
 
+	// Records the most recent log lines in a memory-mapped ring file, the log file
+	// is no longer flushed after every line when this is enabled.
+	bool EnableFlightRecorder(const std::filesystem::path& path, uint32_t capacityInBytes);
+
+	// Closes the flight recorder to mark the session as cleanly ended, and flushes the log file.
+	void DisableFlightRecorder();
+
 	void WriteLogFileHeader(const char* const message);
 
 	void WriteLine(LogLevel level, const char* const message);
 
-	void WriteLineFormatted(LogLevel level, const char* const format, ...);
+	void WriteLineFormatted(LogLevel level, _Printf_format_string_ const char* const format, ...);
+
+	// Formats the message into a per-thread buffer in a single pass.
+	// The format string is checked at compile time.
+	template <typename... Args>
+	void Log(LogLevel level, std::format_string<Args...> format, Args&&... args)
+	{
+		if (IsEnabled(level))
+		{
+			std::span<char> buffer = GetThreadFormatBuffer();
+
+			// Leave room for the null terminator.
+			const size_t maxLength = buffer.size() - 1;
+			const auto result = std::format_to_n(buffer.data(), maxLength, format, std::forward<Args>(args)...);
+
+			const size_t length = result.size < 0 || static_cast<size_t>(result.size) > maxLength
+				? maxLength
+				: static_cast<size_t>(result.size);
+			buffer[length] = '\0';
+
+			WriteLineCore(level, buffer.data(), length);
+		}
+	}
 
 private:
 
 	Logger();
 	~Logger();
 
-	void WriteLineCore(const char* const message);
+	static std::span<char> GetThreadFormatBuffer();
+
+	void WriteLineCore(LogLevel level, const char* const message, size_t length);
 
 	bool initialized;
 	bool writeTimeStamp;
 	LogLevel logLevel;
 	std::ofstream logFile;
+	FlightRecorder flightRecorder;
 };
 
+// The arguments are only evaluated if the log level is enabled.
+#define LOG_MESSAGE(level, ...) \
+	do \
+	{ \
+		if constexpr (static_cast<int32_t>(level) <= LOG_MAX_COMPILED_LEVEL) \
+		{ \
+			Logger& logger_ = Logger::GetInstance(); \
+			if (logger_.IsEnabled(level)) \
+			{ \
+				logger_.Log(level, __VA_ARGS__); \
+			} \
+		} \
+	} while (0)
+
+#define LOG_INFO(...) LOG_MESSAGE(LogLevel::Info, __VA_ARGS__)
+#define LOG_ERROR(...) LOG_MESSAGE(LogLevel::Error, __VA_ARGS__)
+#define LOG_DEBUG(...) LOG_MESSAGE(LogLevel::Debug, __VA_ARGS__)
+#define LOG_TRACE(...) LOG_MESSAGE(LogLevel::Trace, __VA_ARGS__)
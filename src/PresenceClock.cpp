@@ -0,0 +1,43 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-discord-rich-presence, a DLL Plugin for
+// SimCity 4 that implements Discord rich presence support.
+//
+// Copyright (c) 2024 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#include "PresenceClock.h"
+
+namespace
+{
+	class StandardPresenceClock final : public PresenceClock
+	{
+	public:
+		SteadyTimePoint GetSteadyTime() const override
+		{
+			return std::chrono::steady_clock::now();
+		}
+
+		SystemTimePoint GetSystemTime() const override
+		{
+			return std::chrono::system_clock::now();
+		}
+	};
+}
+
+int64_t PresenceClock::GetUnixTime() const
+{
+	// The system_clock epoch is the Unix epoch in C++20.
+	return std::chrono::duration_cast<std::chrono::seconds>(GetSystemTime().time_since_epoch()).count();
+}
+
+const PresenceClock& PresenceClock::GetDefault()
+{
+	static const StandardPresenceClock clock;
+
+	return clock;
+}
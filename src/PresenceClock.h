@@ -0,0 +1,40 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-discord-rich-presence, a DLL Plugin for
+// SimCity 4 that implements Discord rich presence support.
+//
+// Copyright (c) 2024 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <chrono>
+#include <cstdint>
+
+// The source of the current time for the presence logic.
+//
+// All of the intervals, timeouts and timestamps are read from this class,
+// so that a replacement clock can run the logic faster than real time.
+class PresenceClock
+{
+public:
+	typedef std::chrono::steady_clock::time_point SteadyTimePoint;
+	typedef std::chrono::system_clock::time_point SystemTimePoint;
+
+	virtual ~PresenceClock() = default;
+
+	// A monotonic time that is used for the intervals and timeouts.
+	virtual SteadyTimePoint GetSteadyTime() const = 0;
+
+	// The wall clock time that is used for the status rotation.
+	virtual SystemTimePoint GetSystemTime() const = 0;
+
+	// The current time as seconds since the Unix epoch.
+	int64_t GetUnixTime() const;
+
+	// Returns a clock that reads the standard library clocks.
+	static const PresenceClock& GetDefault();
+};
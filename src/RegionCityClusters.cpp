@@ -0,0 +1,157 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-discord-rich-presence, a DLL Plugin for
+// SimCity 4 that implements Discord rich presence support.
+//
+// Copyright (c) 2024 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#include "RegionCityClusters.h"
+#include <algorithm>
+
+namespace
+{
+	constexpr uint32_t NoTileOwner = UINT32_MAX;
+}
+
+RegionCityClusters::RegionCityClusters()
+	: width(0),
+	  height(0),
+	  cityGroups(),
+	  tileOwners(),
+	  standaloneCityCount(0),
+	  clusterCount(0),
+	  largestClusterSize(0)
+{
+}
+
+void RegionCityClusters::Reset(uint32_t width, uint32_t height)
+{
+	this->width = width;
+	this->height = height;
+
+	cityGroups.Reset(0);
+	tileOwners.assign(static_cast<size_t>(width) * height, NoTileOwner);
+	standaloneCityCount = 0;
+	clusterCount = 0;
+	largestClusterSize = 0;
+}
+
+void RegionCityClusters::AddCity(uint32_t x, uint32_t y, uint32_t size)
+{
+	if (x >= width || y >= height || size == 0)
+	{
+		return;
+	}
+
+	const uint32_t city = cityGroups.Add();
+	const uint32_t right = std::min(x + size, width);
+	const uint32_t bottom = std::min(y + size, height);
+
+	for (uint32_t row = y; row < bottom; row++)
+	{
+		std::fill_n(tileOwners.begin() + ((static_cast<size_t>(row) * width) + x), right - x, city);
+	}
+
+	standaloneCityCount++;
+	largestClusterSize = std::max(largestClusterSize, 1u);
+
+	// The cities that were added earlier can be on any side of the new city.
+	for (uint32_t row = y; row < bottom; row++)
+	{
+		if (x > 0)
+		{
+			JoinCities(city, GetTileOwner(x - 1, row));
+		}
+
+		JoinCities(city, GetTileOwner(right, row));
+	}
+
+	for (uint32_t column = x; column < right; column++)
+	{
+		if (y > 0)
+		{
+			JoinCities(city, GetTileOwner(column, y - 1));
+		}
+
+		JoinCities(city, GetTileOwner(column, bottom));
+	}
+}
+
+uint32_t RegionCityClusters::GetCityCount() const
+{
+	return cityGroups.GetElementCount();
+}
+
+uint32_t RegionCityClusters::GetBorderingCityCount() const
+{
+	return GetCityCount() - standaloneCityCount;
+}
+
+uint32_t RegionCityClusters::GetStandaloneCityCount() const
+{
+	return standaloneCityCount;
+}
+
+uint32_t RegionCityClusters::GetClusterCount() const
+{
+	return clusterCount;
+}
+
+uint32_t RegionCityClusters::GetLargestClusterSize() const
+{
+	return largestClusterSize;
+}
+
+uint32_t RegionCityClusters::GetTileOwner(uint32_t x, uint32_t y) const
+{
+	if (x >= width || y >= height)
+	{
+		return NoTileOwner;
+	}
+
+	return tileOwners[(static_cast<size_t>(y) * width) + x];
+}
+
+void RegionCityClusters::JoinCities(uint32_t city, uint32_t neighbor)
+{
+	if (neighbor == NoTileOwner)
+	{
+		return;
+	}
+
+	const uint32_t citySetSize = cityGroups.GetSetSize(city);
+	const uint32_t neighborSetSize = cityGroups.GetSetSize(neighbor);
+
+	if (!cityGroups.Union(city, neighbor))
+	{
+		return;
+	}
+
+	// A single city leaves the standalone count when it joins another city,
+	// and joining two existing clusters leaves one cluster.
+	if (citySetSize == 1)
+	{
+		standaloneCityCount--;
+	}
+
+	if (neighborSetSize == 1)
+	{
+		standaloneCityCount--;
+	}
+
+	if (citySetSize == 1 && neighborSetSize == 1)
+	{
+		clusterCount++;
+	}
+	else if (citySetSize > 1 && neighborSetSize > 1)
+	{
+		clusterCount--;
+	}
+
+	largestClusterSize = std::max(largestClusterSize, citySetSize + neighborSetSize);
+}
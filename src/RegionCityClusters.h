@@ -0,0 +1,61 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-discord-rich-presence, a DLL Plugin for
+// SimCity 4 that implements Discord rich presence support.
+//
+// Copyright (c) 2024 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include "DisjointSet.h"
+#include <cstdint>
+#include <vector>
+
+// Groups the established cities whose city tiles share an edge into clusters.
+//
+// A city is joined with its neighbors when it is added, which only checks the
+// tiles along the city's edges instead of comparing every pair of cities.
+// The statistics are updated as each city is added.
+class RegionCityClusters
+{
+public:
+	RegionCityClusters();
+
+	// Removes all of the cities and resizes the region grid.
+	void Reset(uint32_t width, uint32_t height);
+
+	// Adds a city that covers a square of region tiles.
+	void AddCity(uint32_t x, uint32_t y, uint32_t size);
+
+	uint32_t GetCityCount() const;
+
+	// The number of cities that share an edge with at least one other city.
+	uint32_t GetBorderingCityCount() const;
+
+	// The number of cities that do not share an edge with another city.
+	uint32_t GetStandaloneCityCount() const;
+
+	// The number of groups of two or more connected cities.
+	uint32_t GetClusterCount() const;
+
+	// The number of cities in the largest group of connected cities,
+	// a standalone city is a group of one.
+	uint32_t GetLargestClusterSize() const;
+
+private:
+	uint32_t GetTileOwner(uint32_t x, uint32_t y) const;
+	void JoinCities(uint32_t city, uint32_t neighbor);
+
+	uint32_t width;
+	uint32_t height;
+	DisjointSet cityGroups;
+	// The city that covers each region tile, indexed by (y * width) + x.
+	std::vector<uint32_t> tileOwners;
+	uint32_t standaloneCityCount;
+	uint32_t clusterCount;
+	uint32_t largestClusterSize;
+};
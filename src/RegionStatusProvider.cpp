@@ -12,37 +12,74 @@
 
 #include "RegionStatusProvider.h"
 #include "cISC4Region.h"
+#include "Utf8Text.h"
 #include "cISC4RegionalCity.h"
+#include "cRZBaseString.h"
+#include <algorithm>
+
+namespace
+{
+	// A small city tile is 64x64 cells, and each cell is 16x16 meters.
+	constexpr int64_t CellsPerRegionTile = 64 * 64;
+	constexpr int64_t SquareMetersPerRegionTile = CellsPerRegionTile * 16 * 16;
+
+	uint32_t MakeCityId(const cISC4Region::cLocation& location)
+	{
+		// The region tile coordinates are small, so both fit in one 32-bit value.
+		return (location.x << 16) | (location.y & 0xFFFF);
+	}
+
+	uint32_t GetCitySizeInTiles(cISC4Region::eCityTileSize cityTileSize)
+	{
+		switch (cityTileSize)
+		{
+		case cISC4Region::eCityTileSize::Large:
+			return 4;
+		case cISC4Region::eCityTileSize::Medium:
+			return 2;
+		case cISC4Region::eCityTileSize::Small:
+		default:
+			return 1;
+		}
+	}
+}
 
 RegionStatusProvider::RegionStatusProvider()
-	: totalResidentialPopulation(0),
-	  totalCommercialJobs(0),
-	  totalIndustrialJobs(0),
-	  totalFunds(0),
+	: totals(),
 	  totalCities(0),
-	  developedCityCount(0),
-	  undevelopedCityCount(0)
+	  cities(),
+	  populationLeaderboard(),
+	  fundsLeaderboard(),
+	  densityLeaderboard(),
+	  regionWidth(0),
+	  regionHeight(0),
+	  regionTiles(),
+	  developedTiles(),
+	  regionTileCount(0),
+	  developedTileCount(0),
+	  updateGeneration(0),
+	  cityClusters()
 {
 }
 
 int64_t RegionStatusProvider::GetTotalResidentialPopulation() const
 {
-	return totalResidentialPopulation;
+	return totals.GetTotalResidentialPopulation();
 }
 
 int64_t RegionStatusProvider::GetTotalCommercialJobs() const
 {
-	return totalCommercialJobs;
+	return totals.GetTotalCommercialJobs();
 }
 
 int64_t RegionStatusProvider::GetTotalIndustrialJobs() const
 {
-	return totalIndustrialJobs;
+	return totals.GetTotalIndustrialJobs();
 }
 
 int64_t RegionStatusProvider::GetTotalFunds() const
 {
-	return totalFunds;
+	return totals.GetTotalFunds();
 }
 
 uint32_t RegionStatusProvider::GetTotalCities() const
@@ -52,23 +89,73 @@ uint32_t RegionStatusProvider::GetTotalCities() const
 
 uint32_t RegionStatusProvider::GetDevelopedCityCount() const
 {
-	return developedCityCount;
+	return totals.GetDevelopedCityCount();
 }
 
 uint32_t RegionStatusProvider::GetUndevelopedCityCount() const
 {
-	return undevelopedCityCount;
+	return totals.GetUndevelopedCityCount();
+}
+
+const RegionStatusProvider::RegionalCityInfo* RegionStatusProvider::GetLargestCity() const
+{
+	return GetLeader(populationLeaderboard);
+}
+
+const RegionStatusProvider::RegionalCityInfo* RegionStatusProvider::GetRichestCity() const
+{
+	return GetLeader(fundsLeaderboard);
+}
+
+const RegionStatusProvider::RegionalCityInfo* RegionStatusProvider::GetDensestCity() const
+{
+	return GetLeader(densityLeaderboard);
+}
+
+uint32_t RegionStatusProvider::GetDevelopedLandPercentage() const
+{
+	if (regionTileCount == 0)
+	{
+		return 0;
+	}
+
+	return static_cast<uint32_t>((static_cast<uint64_t>(developedTileCount) * 100) / regionTileCount);
+}
+
+int64_t RegionStatusProvider::GetDevelopedCellCount() const
+{
+	return static_cast<int64_t>(developedTileCount) * CellsPerRegionTile;
+}
+
+uint32_t RegionStatusProvider::GetBorderingCityCount() const
+{
+	return cityClusters.GetBorderingCityCount();
+}
+
+uint32_t RegionStatusProvider::GetStandaloneCityCount() const
+{
+	return cityClusters.GetStandaloneCityCount();
+}
+
+uint32_t RegionStatusProvider::GetCityClusterCount() const
+{
+	return cityClusters.GetClusterCount();
+}
+
+uint32_t RegionStatusProvider::GetLargestCityClusterSize() const
+{
+	return cityClusters.GetLargestClusterSize();
 }
 
 void RegionStatusProvider::SetupRegionStatusData(cISC4Region* pRegion)
 {
-	totalResidentialPopulation = 0;
-	totalCommercialJobs = 0;
-	totalIndustrialJobs = 0;
-	totalFunds = 0;
+	totals.Reset();
 	totalCities = 0;
-	developedCityCount = 0;
-	undevelopedCityCount = 0;
+	regionWidth = 0;
+	regionHeight = 0;
+	regionTileCount = 0;
+	developedTileCount = 0;
+	updateGeneration++;
 
 	if (pRegion)
 	{
@@ -80,9 +167,25 @@ void RegionStatusProvider::SetupRegionStatusData(cISC4Region* pRegion)
 
 		totalCities = count;
 
+		// The region is fully covered by city tiles, so the city locations define its bounds.
 		for (uint32_t i = 0; i < count; i++)
 		{
 			const cISC4Region::cLocation& cityLocation = cityLocations[i];
+			const uint32_t size = GetCitySizeInTiles(cityLocation.cityTileSize);
+
+			regionWidth = std::max(regionWidth, cityLocation.x + size);
+			regionHeight = std::max(regionHeight, cityLocation.y + size);
+		}
+
+		regionTiles.Reset(regionWidth, regionHeight);
+		developedTiles.Reset(regionWidth, regionHeight);
+
+		for (uint32_t i = 0; i < count; i++)
+		{
+			const cISC4Region::cLocation& cityLocation = cityLocations[i];
+			const uint32_t size = GetCitySizeInTiles(cityLocation.cityTileSize);
+
+			regionTiles.SetCityTiles(cityLocation.x, cityLocation.y, size);
 
 			cISC4RegionalCity** ppRegionalCity = pRegion->GetCity(cityLocation.x, cityLocation.y);
 
@@ -90,20 +193,116 @@ void RegionStatusProvider::SetupRegionStatusData(cISC4Region* pRegion)
 			{
 				cISC4RegionalCity* pRegionalCity = *ppRegionalCity;
 
-				if (pRegionalCity->GetEstablished())
+				RegionalCitySummary summary{};
+				summary.established = pRegionalCity->GetEstablished();
+
+				if (summary.established)
 				{
-					totalResidentialPopulation += pRegionalCity->GetPopulation();
-					totalCommercialJobs += pRegionalCity->GetCommercialJobs();
-					totalIndustrialJobs += pRegionalCity->GetIndustrialJobs();
-					totalFunds += static_cast<int64_t>(pRegionalCity->GetBudget());
-					developedCityCount++;
+					summary.residentialPopulation = pRegionalCity->GetPopulation();
+					summary.commercialJobs = pRegionalCity->GetCommercialJobs();
+					summary.industrialJobs = pRegionalCity->GetIndustrialJobs();
+					summary.funds = static_cast<int64_t>(pRegionalCity->GetBudget());
 				}
-				else
+
+				totals.AddCity(summary);
+
+				if (summary.established)
 				{
-					undevelopedCityCount++;
+					developedTiles.SetCityTiles(cityLocation.x, cityLocation.y, size);
+					UpdateCityInfo(cityLocation, pRegionalCity, summary);
 				}
 			}
 		}
+
+		regionTileCount = regionTiles.GetCount();
+		developedTileCount = developedTiles.GetCount();
+	}
+	else
+	{
+		regionTiles.Reset(0, 0);
+		developedTiles.Reset(0, 0);
+	}
+
+	// The cities that were not visited have been abandoned or belong to a different region.
+	RemoveStaleCities();
+	UpdateCityClusters();
+}
+
+const RegionStatusProvider::RegionalCityInfo* RegionStatusProvider::GetLeader(const CityLeaderboard& leaderboard) const
+{
+	CityLeaderboard::Entry entry{};
+
+	if (leaderboard.GetLeader(entry))
+	{
+		auto it = cities.find(entry.cityId);
+
+		if (it != cities.end())
+		{
+			return &it->second;
+		}
+	}
+
+	return nullptr;
+}
+
+void RegionStatusProvider::UpdateCityInfo(
+	const cISC4Region::cLocation& location,
+	cISC4RegionalCity* pRegionalCity,
+	const RegionalCitySummary& summary)
+{
+	const uint32_t cityId = MakeCityId(location);
+
+	RegionalCityInfo& info = cities[cityId];
+	info.population = summary.residentialPopulation;
+	info.funds = summary.funds;
+	info.x = location.x;
+	info.y = location.y;
+	info.size = GetCitySizeInTiles(location.cityTileSize);
+	info.density = (info.population * 1000000) / (static_cast<int64_t>(info.size * info.size) * SquareMetersPerRegionTile);
+	info.updateGeneration = updateGeneration;
+
+	cRZBaseString name;
+
+	if (pRegionalCity->GetCityName(name))
+	{
+		info.name = Utf8Text::ToValidUtf8(name.ToChar(), name.Strlen());
+	}
+
+	// Only the cities whose values have changed are moved in the rankings.
+	populationLeaderboard.Update(cityId, info.population);
+	fundsLeaderboard.Update(cityId, info.funds);
+	densityLeaderboard.Update(cityId, info.density);
+}
+
+void RegionStatusProvider::RemoveStaleCities()
+{
+	for (auto it = cities.begin(); it != cities.end();)
+	{
+		if (it->second.updateGeneration != updateGeneration)
+		{
+			populationLeaderboard.Remove(it->first);
+			fundsLeaderboard.Remove(it->first);
+			densityLeaderboard.Remove(it->first);
+			it = cities.erase(it);
+		}
+		else
+		{
+			++it;
+		}
+	}
+}
+
+void RegionStatusProvider::UpdateCityClusters()
+{
+	// The clusters are rebuilt when the region is loaded, a union-find structure
+	// cannot split a cluster when a city is removed.
+	cityClusters.Reset(regionWidth, regionHeight);
+
+	for (const auto& item : cities)
+	{
+		const RegionalCityInfo& info = item.second;
+
+		cityClusters.AddCity(info.x, info.y, info.size);
 	}
 }
 
@@ -11,13 +11,34 @@
 ////////////////////////////////////////////////////////////////////////
 
 #pragma once
+#include "CityLeaderboard.h"
+#include "RegionCityClusters.h"
+#include "RegionTileOccupancy.h"
+#include "RegionTotals.h"
+#include "cISC4Region.h"
 #include <cstdint>
+#include <string>
+#include <unordered_map>
 
-class cISC4Region;
+class cISC4RegionalCity;
 
 class RegionStatusProvider
 {
 public:
+	struct RegionalCityInfo
+	{
+		std::string name;
+		int64_t population;
+		int64_t funds;
+		// The residential population per square kilometer.
+		int64_t density;
+		// The city's position and size in region tiles.
+		uint32_t x;
+		uint32_t y;
+		uint32_t size;
+		uint32_t updateGeneration;
+	};
+
 	RegionStatusProvider();
 
 	int64_t GetTotalResidentialPopulation() const;
@@ -29,15 +50,65 @@ public:
 	uint32_t GetDevelopedCityCount() const;
 	uint32_t GetUndevelopedCityCount() const;
 
+	// Returns the established city with the largest population, or nullptr if
+	// the region does not have any established cities.
+	const RegionalCityInfo* GetLargestCity() const;
+
+	// Returns the established city with the most funds, or nullptr if
+	// the region does not have any established cities.
+	const RegionalCityInfo* GetRichestCity() const;
+
+	// Returns the established city with the highest population density, or nullptr if
+	// the region does not have any established cities.
+	const RegionalCityInfo* GetDensestCity() const;
+
+	// The percentage of the region's land that is covered by established cities.
+	uint32_t GetDevelopedLandPercentage() const;
+
+	// The number of city cells that are covered by established cities.
+	int64_t GetDevelopedCellCount() const;
+
+	// The number of established cities whose city tile shares an edge with
+	// at least one other established city.
+	// This is based on the city tile positions, not the neighbor connections.
+	uint32_t GetBorderingCityCount() const;
+
+	// The number of established cities whose city tile does not share an edge
+	// with another established city.
+	uint32_t GetStandaloneCityCount() const;
+
+	// The number of groups of two or more established cities that are connected
+	// through shared city tile edges.
+	uint32_t GetCityClusterCount() const;
+
+	// The number of established cities in the largest connected group.
+	uint32_t GetLargestCityClusterSize() const;
+
 	void SetupRegionStatusData(cISC4Region*);
 
 private:
-	int64_t totalResidentialPopulation;
-	int64_t totalCommercialJobs;
-	int64_t totalIndustrialJobs;
-	int64_t totalFunds;
-	size_t totalCities;
-	size_t developedCityCount;
-	size_t undevelopedCityCount;
+	const RegionalCityInfo* GetLeader(const CityLeaderboard& leaderboard) const;
+	void UpdateCityInfo(
+		const cISC4Region::cLocation& location,
+		cISC4RegionalCity* pRegionalCity,
+		const RegionalCitySummary& summary);
+	void RemoveStaleCities();
+	void UpdateCityClusters();
+
+	RegionTotals totals;
+	uint32_t totalCities;
+	// The established cities, keyed by their tile location in the region.
+	std::unordered_map<uint32_t, RegionalCityInfo> cities;
+	CityLeaderboard populationLeaderboard;
+	CityLeaderboard fundsLeaderboard;
+	CityLeaderboard densityLeaderboard;
+	uint32_t regionWidth;
+	uint32_t regionHeight;
+	RegionTileOccupancy regionTiles;
+	RegionTileOccupancy developedTiles;
+	uint32_t regionTileCount;
+	uint32_t developedTileCount;
+	uint32_t updateGeneration;
+	RegionCityClusters cityClusters;
 };
 
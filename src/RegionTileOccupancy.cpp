@@ -0,0 +1,78 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-discord-rich-presence, a DLL Plugin for
+// SimCity 4 that implements Discord rich presence support.
+//
+// Copyright (c) 2024 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#include "RegionTileOccupancy.h"
+#include <algorithm>
+#include <bit>
+
+RegionTileOccupancy::RegionTileOccupancy()
+	: width(0),
+	  height(0),
+	  wordsPerRow(0),
+	  words()
+{
+}
+
+void RegionTileOccupancy::Reset(uint32_t width, uint32_t height)
+{
+	this->width = width;
+	this->height = height;
+	wordsPerRow = (width + 63) / 64;
+
+	words.assign(static_cast<size_t>(wordsPerRow) * height, 0);
+}
+
+void RegionTileOccupancy::SetCityTiles(uint32_t x, uint32_t y, uint32_t size)
+{
+	if (x >= width || y >= height)
+	{
+		return;
+	}
+
+	const uint32_t columnCount = std::min(size, width - x);
+	const uint32_t rowEnd = y + std::min(size, height - y);
+
+	for (uint32_t row = y; row < rowEnd; row++)
+	{
+		SetRowBits(row, x, columnCount);
+	}
+}
+
+uint32_t RegionTileOccupancy::GetCount() const
+{
+	uint32_t count = 0;
+
+	// std::popcount compiles to the POPCNT instruction when the CPU supports it.
+	for (const uint64_t word : words)
+	{
+		count += static_cast<uint32_t>(std::popcount(word));
+	}
+
+	return count;
+}
+
+void RegionTileOccupancy::SetRowBits(uint32_t y, uint32_t x, uint32_t count)
+{
+	uint64_t* row = words.data() + (static_cast<size_t>(y) * wordsPerRow);
+
+	while (count > 0)
+	{
+		const uint32_t bitIndex = x % 64;
+		const uint32_t bitCount = std::min(count, 64 - bitIndex);
+		const uint64_t mask = bitCount == 64 ? ~uint64_t(0) : ((uint64_t(1) << bitCount) - 1);
+
+		row[x / 64] |= mask << bitIndex;
+
+		x += bitCount;
+		count -= bitCount;
+	}
+}
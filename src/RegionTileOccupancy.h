@@ -0,0 +1,41 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-discord-rich-presence, a DLL Plugin for
+// SimCity 4 that implements Discord rich presence support.
+//
+// Copyright (c) 2024 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// A packed bitset of the region tiles, one bit per tile.
+// Each row is padded to a whole number of 64-bit words, so the set tiles
+// can be counted a word at a time.
+class RegionTileOccupancy
+{
+public:
+	RegionTileOccupancy();
+
+	// Resizes the grid and clears all of the tiles.
+	void Reset(uint32_t width, uint32_t height);
+
+	// Sets the square of tiles that is covered by a city.
+	void SetCityTiles(uint32_t x, uint32_t y, uint32_t size);
+
+	// Returns the number of set tiles.
+	uint32_t GetCount() const;
+
+private:
+	void SetRowBits(uint32_t y, uint32_t x, uint32_t count);
+
+	uint32_t width;
+	uint32_t height;
+	uint32_t wordsPerRow;
+	std::vector<uint64_t> words;
+};
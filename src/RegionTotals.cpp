@@ -0,0 +1,74 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-discord-rich-presence, a DLL Plugin for
+// SimCity 4 that implements Discord rich presence support.
+//
+// Copyright (c) 2024 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#include "RegionTotals.h"
+
+RegionTotals::RegionTotals()
+	: totalResidentialPopulation(0),
+	  totalCommercialJobs(0),
+	  totalIndustrialJobs(0),
+	  totalFunds(0),
+	  developedCityCount(0),
+	  undevelopedCityCount(0)
+{
+}
+
+int64_t RegionTotals::GetTotalResidentialPopulation() const
+{
+	return totalResidentialPopulation;
+}
+
+int64_t RegionTotals::GetTotalCommercialJobs() const
+{
+	return totalCommercialJobs;
+}
+
+int64_t RegionTotals::GetTotalIndustrialJobs() const
+{
+	return totalIndustrialJobs;
+}
+
+int64_t RegionTotals::GetTotalFunds() const
+{
+	return totalFunds;
+}
+
+uint32_t RegionTotals::GetDevelopedCityCount() const
+{
+	return developedCityCount;
+}
+
+uint32_t RegionTotals::GetUndevelopedCityCount() const
+{
+	return undevelopedCityCount;
+}
+
+void RegionTotals::AddCity(const RegionalCitySummary& city)
+{
+	if (city.established)
+	{
+		totalResidentialPopulation += city.residentialPopulation;
+		totalCommercialJobs += city.commercialJobs;
+		totalIndustrialJobs += city.industrialJobs;
+		totalFunds += city.funds;
+		developedCityCount++;
+	}
+	else
+	{
+		undevelopedCityCount++;
+	}
+}
+
+void RegionTotals::Reset()
+{
+	*this = RegionTotals();
+}
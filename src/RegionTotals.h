@@ -0,0 +1,51 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-discord-rich-presence, a DLL Plugin for
+// SimCity 4 that implements Discord rich presence support.
+//
+// Copyright (c) 2024 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <cstdint>
+
+// The values of a city tile that are used for the region totals.
+struct RegionalCitySummary
+{
+	bool established;
+	int64_t residentialPopulation;
+	int64_t commercialJobs;
+	int64_t industrialJobs;
+	int64_t funds;
+};
+
+// Aggregates the region totals from the city summaries.
+// This does not depend on the game.
+class RegionTotals
+{
+public:
+	RegionTotals();
+
+	int64_t GetTotalResidentialPopulation() const;
+	int64_t GetTotalCommercialJobs() const;
+	int64_t GetTotalIndustrialJobs() const;
+	int64_t GetTotalFunds() const;
+
+	uint32_t GetDevelopedCityCount() const;
+	uint32_t GetUndevelopedCityCount() const;
+
+	void AddCity(const RegionalCitySummary& city);
+	void Reset();
+
+private:
+	int64_t totalResidentialPopulation;
+	int64_t totalCommercialJobs;
+	int64_t totalIndustrialJobs;
+	int64_t totalFunds;
+	uint32_t developedCityCount;
+	uint32_t undevelopedCityCount;
+};
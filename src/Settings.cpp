@@ -0,0 +1,221 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-discord-rich-presence, a DLL Plugin for
+// SimCity 4 that implements Discord rich presence support.
+//
+// Copyright (c) 2024 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#include "Settings.h"
+#include "Logger.h"
+#include <cwchar>
+#include <utility>
+#include <Windows.h>
+
+namespace
+{
+	constexpr double DefaultSignificanceThreshold = 0.1;
+	constexpr uint32_t DefaultFlightRecorderSizeInKB = 64;
+	constexpr uint32_t DefaultIdleTimeBudgetInMicroseconds = 0;
+	constexpr uint32_t MaxFlightRecorderSizeInKB = 16384;
+
+	double ReadDouble(
+		const wchar_t* section,
+		const wchar_t* key,
+		double defaultValue,
+		const std::filesystem::path& path)
+	{
+		wchar_t buffer[64]{};
+
+		const DWORD length = GetPrivateProfileStringW(
+			section,
+			key,
+			L"",
+			buffer,
+			static_cast<DWORD>(std::size(buffer)),
+			path.c_str());
+
+		if (length > 0)
+		{
+			wchar_t* end = nullptr;
+			const double value = std::wcstod(buffer, &end);
+
+			if (end != buffer)
+			{
+				return value;
+			}
+		}
+
+		return defaultValue;
+	}
+
+	std::string ConvertToUtf8(const wchar_t* text, size_t length)
+	{
+		std::string result;
+
+		if (length > 0)
+		{
+			const int utf8Length = WideCharToMultiByte(
+				CP_UTF8,
+				0,
+				text,
+				static_cast<int>(length),
+				nullptr,
+				0,
+				nullptr,
+				nullptr);
+
+			if (utf8Length > 0)
+			{
+				result.resize(static_cast<size_t>(utf8Length));
+
+				WideCharToMultiByte(
+					CP_UTF8,
+					0,
+					text,
+					static_cast<int>(length),
+					result.data(),
+					utf8Length,
+					nullptr,
+					nullptr);
+			}
+		}
+
+		return result;
+	}
+
+	void ReadStatusTemplates(
+		const wchar_t* section,
+		const std::filesystem::path& path,
+		std::vector<StatusTemplateSetting>& templates)
+	{
+		// The maximum size of an INI file section.
+		std::vector<wchar_t> buffer(32767);
+
+		const DWORD length = GetPrivateProfileSectionW(
+			section,
+			buffer.data(),
+			static_cast<DWORD>(buffer.size()),
+			path.c_str());
+
+		// The section is a list of null-terminated key=value strings.
+		const wchar_t* entry = buffer.data();
+		const wchar_t* const end = entry + length;
+
+		while (entry < end && *entry != L'\0')
+		{
+			const size_t entryLength = std::wcslen(entry);
+			const wchar_t* separator = std::wmemchr(entry, L'=', entryLength);
+
+			if (separator)
+			{
+				StatusTemplateSetting setting;
+				setting.name = ConvertToUtf8(entry, static_cast<size_t>(separator - entry));
+				setting.text = ConvertToUtf8(separator + 1, entryLength - static_cast<size_t>(separator - entry) - 1);
+
+				templates.push_back(std::move(setting));
+			}
+
+			entry += entryLength + 1;
+		}
+	}
+}
+
+Settings::Settings()
+	: significanceThreshold(DefaultSignificanceThreshold),
+	  showPausedStatus(false),
+	  idleTimeBudgetInMicroseconds(DefaultIdleTimeBudgetInMicroseconds),
+	  flightRecorderSizeInKB(DefaultFlightRecorderSizeInKB),
+	  flightRecorderEnabled(false),
+	  cityStatusTemplates(),
+	  regionStatusTemplates()
+{
+}
+
+void Settings::Load(const std::filesystem::path& path)
+{
+	std::error_code ec;
+
+	if (!std::filesystem::exists(path, ec))
+	{
+		return;
+	}
+
+	const double threshold = ReadDouble(L"Status", L"SignificanceThreshold", DefaultSignificanceThreshold, path);
+
+	if (threshold > 0.0)
+	{
+		significanceThreshold = threshold;
+	}
+	else
+	{
+		LOG_ERROR("The SignificanceThreshold setting must be greater than zero, using the default value.");
+	}
+
+	showPausedStatus = GetPrivateProfileIntW(L"Status", L"ShowPaused", 0, path.c_str()) != 0;
+
+	idleTimeBudgetInMicroseconds = GetPrivateProfileIntW(
+		L"Performance",
+		L"IdleTimeBudgetMicroseconds",
+		DefaultIdleTimeBudgetInMicroseconds,
+		path.c_str());
+
+	flightRecorderEnabled = GetPrivateProfileIntW(L"Logging", L"FlightRecorder", 0, path.c_str()) != 0;
+
+	const uint32_t sizeInKB = GetPrivateProfileIntW(
+		L"Logging",
+		L"FlightRecorderSizeKB",
+		DefaultFlightRecorderSizeInKB,
+		path.c_str());
+
+	if (sizeInKB > 0 && sizeInKB <= MaxFlightRecorderSizeInKB)
+	{
+		flightRecorderSizeInKB = sizeInKB;
+	}
+	else
+	{
+		LOG_ERROR("The FlightRecorderSizeKB setting must be between 1 and {}, using the default value.", MaxFlightRecorderSizeInKB);
+	}
+
+	ReadStatusTemplates(L"CityStatusTemplates", path, cityStatusTemplates);
+	ReadStatusTemplates(L"RegionStatusTemplates", path, regionStatusTemplates);
+}
+
+double Settings::GetSignificanceThreshold() const
+{
+	return significanceThreshold;
+}
+
+bool Settings::GetShowPausedStatus() const
+{
+	return showPausedStatus;
+}
+
+uint32_t Settings::GetIdleTimeBudgetInMicroseconds() const
+{
+	return idleTimeBudgetInMicroseconds;
+}
+
+bool Settings::GetFlightRecorderEnabled() const
+{
+	return flightRecorderEnabled;
+}
+
+uint32_t Settings::GetFlightRecorderSizeInKB() const
+{
+	return flightRecorderSizeInKB;
+}
+
+const std::vector<StatusTemplateSetting>& Settings::GetCityStatusTemplates() const
+{
+	return cityStatusTemplates;
+}
+
+const std::vector<StatusTemplateSetting>& Settings::GetRegionStatusTemplates() const
+{
+	return regionStatusTemplates;
+}
@@ -0,0 +1,59 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-discord-rich-presence, a DLL Plugin for
+// SimCity 4 that implements Discord rich presence support.
+//
+// Copyright (c) 2024 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+struct StatusTemplateSetting
+{
+	std::string name;
+	// The template text, encoded as UTF-8.
+	std::string text;
+};
+
+class Settings
+{
+public:
+	Settings();
+
+	void Load(const std::filesystem::path& path);
+
+	// The relative change that allows a status to be shown before the
+	// rotation interval has elapsed, e.g. 0.1 is a 10% change.
+	double GetSignificanceThreshold() const;
+
+	// Shows Paused as the city status while the simulation is paused.
+	bool GetShowPausedStatus() const;
+
+	// The maximum time that the plugin spends in a single idle call, or 0 for no limit.
+	uint32_t GetIdleTimeBudgetInMicroseconds() const;
+
+	bool GetFlightRecorderEnabled() const;
+
+	uint32_t GetFlightRecorderSizeInKB() const;
+
+	const std::vector<StatusTemplateSetting>& GetCityStatusTemplates() const;
+
+	const std::vector<StatusTemplateSetting>& GetRegionStatusTemplates() const;
+
+private:
+	double significanceThreshold;
+	bool showPausedStatus;
+	uint32_t idleTimeBudgetInMicroseconds;
+	uint32_t flightRecorderSizeInKB;
+	bool flightRecorderEnabled;
+	std::vector<StatusTemplateSetting> cityStatusTemplates;
+	std::vector<StatusTemplateSetting> regionStatusTemplates;
+};
@@ -0,0 +1,152 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-discord-rich-presence, a DLL Plugin for
+// SimCity 4 that implements Discord rich presence support.
+//
+// Copyright (c) 2024 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#include "StatusScheduler.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	// A status that has not changed since it was last shown has its staleness score
+	// reduced by this factor, this lets the statuses that have changed appear more often.
+	constexpr double UnchangedStalenessFactor = 0.5;
+
+	constexpr double DefaultSignificanceThreshold = 0.1;
+}
+
+StatusScheduler::StatusScheduler(size_t statusCount, std::chrono::seconds rotationInterval)
+	: entries(statusCount),
+	  rotationInterval(rotationInterval),
+	  significanceThreshold(DefaultSignificanceThreshold),
+	  currentIndex(0),
+	  currentShownTime()
+{
+}
+
+void StatusScheduler::SetSignificanceThreshold(double threshold)
+{
+	if (threshold > 0.0)
+	{
+		significanceThreshold = threshold;
+	}
+}
+
+void StatusScheduler::Reset(size_t index, TimePoint now)
+{
+	for (Entry& entry : entries)
+	{
+		entry.shownValue = entry.currentValue;
+		entry.lastShownTime = now;
+	}
+
+	currentIndex = index;
+	currentShownTime = now;
+}
+
+void StatusScheduler::SetValue(size_t index, double value)
+{
+	if (index < entries.size())
+	{
+		entries[index].currentValue = value;
+	}
+}
+
+void StatusScheduler::MarkShown(size_t index, TimePoint now)
+{
+	if (index < entries.size())
+	{
+		Entry& entry = entries[index];
+
+		entry.shownValue = entry.currentValue;
+		entry.lastShownTime = now;
+
+		currentIndex = index;
+		currentShownTime = now;
+	}
+}
+
+bool StatusScheduler::SelectSignificantChange(size_t& index) const
+{
+	bool result = false;
+	double largestChange = significanceThreshold;
+
+	for (size_t i = 0; i < entries.size(); i++)
+	{
+		const double change = GetRelativeChange(entries[i]);
+
+		if (change >= largestChange)
+		{
+			largestChange = change;
+			index = i;
+			result = true;
+		}
+	}
+
+	return result;
+}
+
+void StatusScheduler::SetRotationInterval(std::chrono::seconds interval)
+{
+	if (interval.count() > 0)
+	{
+		rotationInterval = interval;
+	}
+}
+
+bool StatusScheduler::SelectNext(size_t& index, TimePoint now) const
+{
+	if (entries.empty() || (now - currentShownTime) < rotationInterval)
+	{
+		return false;
+	}
+
+	// The search starts after the current status so that statuses with equal
+	// scores are shown in their rotation order.
+	const size_t count = entries.size();
+	double highestScore = -1.0;
+
+	for (size_t offset = 1; offset <= count; offset++)
+	{
+		const size_t i = (currentIndex + offset) % count;
+		const double score = i == currentIndex ? 0.0 : GetScore(entries[i], now);
+
+		if (score > highestScore)
+		{
+			highestScore = score;
+			index = i;
+		}
+	}
+
+	return true;
+}
+
+double StatusScheduler::GetRelativeChange(const Entry& entry) const
+{
+	const double difference = std::abs(entry.currentValue - entry.shownValue);
+
+	return difference / std::max(std::abs(entry.shownValue), 1.0);
+}
+
+double StatusScheduler::GetScore(const Entry& entry, TimePoint now) const
+{
+	const double change = GetRelativeChange(entry);
+	const double secondsSinceShown = std::chrono::duration<double>(now - entry.lastShownTime).count();
+
+	double staleness = secondsSinceShown / static_cast<double>(rotationInterval.count());
+
+	if (change == 0.0)
+	{
+		staleness *= UnchangedStalenessFactor;
+	}
+
+	return (change / significanceThreshold) + staleness;
+}
@@ -0,0 +1,65 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-discord-rich-presence, a DLL Plugin for
+// SimCity 4 that implements Discord rich presence support.
+//
+// Copyright (c) 2024 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+// Selects the status line that is shown next.
+//
+// Each status has a score that is based on how much its value has changed since
+// it was last shown and on how long ago it was shown.
+// A status whose value has changed by at least the significance threshold can
+// replace the current status before the rotation interval has elapsed.
+class StatusScheduler
+{
+public:
+	typedef std::chrono::time_point<std::chrono::system_clock> TimePoint;
+
+	StatusScheduler(size_t statusCount, std::chrono::seconds rotationInterval);
+
+	void SetSignificanceThreshold(double threshold);
+
+	void SetRotationInterval(std::chrono::seconds interval);
+
+	// Marks all of the current values as shown.
+	void Reset(size_t currentIndex, TimePoint now);
+
+	void SetValue(size_t index, double value);
+
+	void MarkShown(size_t index, TimePoint now);
+
+	// Gets the status with the largest change that meets the significance threshold.
+	// Returns false if no status has changed significantly since it was last shown.
+	bool SelectSignificantChange(size_t& index) const;
+
+	// Gets the highest scoring status, or false if the rotation interval has not elapsed.
+	bool SelectNext(size_t& index, TimePoint now) const;
+
+private:
+	struct Entry
+	{
+		double currentValue;
+		double shownValue;
+		TimePoint lastShownTime;
+	};
+
+	double GetRelativeChange(const Entry& entry) const;
+	double GetScore(const Entry& entry, TimePoint now) const;
+
+	std::vector<Entry> entries;
+	std::chrono::seconds rotationInterval;
+	double significanceThreshold;
+	size_t currentIndex;
+	TimePoint currentShownTime;
+};
@@ -0,0 +1,279 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-discord-rich-presence, a DLL Plugin for
+// SimCity 4 that implements Discord rich presence support.
+//
+// Copyright (c) 2024 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#include "StatusTemplate.h"
+#include "Utf8Text.h"
+#include <cstring>
+
+namespace
+{
+	// The section symbol (§) encoded as UTF-8, SC4 uses it for the simoleon symbol.
+	constexpr char MoneySymbol[] = "\xC2\xA7";
+
+	bool TryParseFormat(const std::string& text, StatusTemplateFormat& format)
+	{
+		if (text == "number")
+		{
+			format = StatusTemplateFormat::Number;
+		}
+		else if (text == "money")
+		{
+			format = StatusTemplateFormat::Money;
+		}
+		else if (text == "raw")
+		{
+			format = StatusTemplateFormat::Raw;
+		}
+		else
+		{
+			return false;
+		}
+
+		return true;
+	}
+
+	class OutputBuffer
+	{
+	public:
+		OutputBuffer(char* buffer, size_t bufferSize)
+			: buffer(buffer),
+			  capacity(bufferSize - 1),
+			  length(0),
+			  truncated(false)
+		{
+		}
+
+		void Append(const char* text, size_t textLength)
+		{
+			if (truncated)
+			{
+				return;
+			}
+
+			const size_t available = capacity - length;
+
+			if (textLength > available)
+			{
+				textLength = Utf8Text::FindTruncationPoint(text, textLength, available);
+				truncated = true;
+			}
+
+			std::memcpy(buffer + length, text, textLength);
+			length += textLength;
+		}
+
+		void AppendNumber(int64_t value, StatusTemplateFormat format)
+		{
+			char digits[32];
+			size_t digitCount = 0;
+
+			// Negate as an unsigned value, so that INT64_MIN is handled correctly.
+			uint64_t magnitude = value < 0 ? (0 - static_cast<uint64_t>(value)) : static_cast<uint64_t>(value);
+
+			do
+			{
+				digits[digitCount++] = static_cast<char>('0' + (magnitude % 10));
+				magnitude /= 10;
+			} while (magnitude > 0);
+
+			char text[48];
+			size_t textLength = 0;
+
+			if (value < 0)
+			{
+				text[textLength++] = '-';
+			}
+
+			if (format == StatusTemplateFormat::Money)
+			{
+				std::memcpy(text + textLength, MoneySymbol, sizeof(MoneySymbol) - 1);
+				textLength += sizeof(MoneySymbol) - 1;
+			}
+
+			const bool groupDigits = format != StatusTemplateFormat::Raw;
+
+			while (digitCount > 0)
+			{
+				text[textLength++] = digits[--digitCount];
+
+				if (groupDigits && digitCount > 0 && (digitCount % 3) == 0)
+				{
+					text[textLength++] = ',';
+				}
+			}
+
+			Append(text, textLength);
+		}
+
+		size_t Finish()
+		{
+			buffer[length] = '\0';
+			return length;
+		}
+
+	private:
+		char* const buffer;
+		const size_t capacity;
+		size_t length;
+		bool truncated;
+	};
+}
+
+StatusTemplate::StatusTemplate()
+	: tokens(),
+	  literals()
+{
+}
+
+bool StatusTemplate::Compile(
+	const std::string& text,
+	const StatusTemplateVariable* variables,
+	size_t variableCount,
+	std::string& errorMessage)
+{
+	tokens.clear();
+	literals.clear();
+
+	const size_t length = text.size();
+	size_t i = 0;
+
+	while (i < length)
+	{
+		const char c = text[i];
+
+		if (c == '{' && (i + 1) < length && text[i + 1] != '{')
+		{
+			const size_t end = text.find('}', i + 1);
+
+			if (end == std::string::npos)
+			{
+				errorMessage = "Missing } after {";
+				tokens.clear();
+				literals.clear();
+				return false;
+			}
+
+			const std::string reference = text.substr(i + 1, end - i - 1);
+			const size_t separator = reference.find(':');
+			const std::string name = reference.substr(0, separator);
+
+			size_t variableIndex = variableCount;
+
+			for (size_t j = 0; j < variableCount; j++)
+			{
+				if (name == variables[j].name)
+				{
+					variableIndex = j;
+					break;
+				}
+			}
+
+			if (variableIndex == variableCount)
+			{
+				errorMessage = "Unknown value: " + name;
+				tokens.clear();
+				literals.clear();
+				return false;
+			}
+
+			StatusTemplateFormat format = variables[variableIndex].defaultFormat;
+
+			if (separator != std::string::npos)
+			{
+				const std::string formatName = reference.substr(separator + 1);
+
+				if (format == StatusTemplateFormat::Text || !TryParseFormat(formatName, format))
+				{
+					errorMessage = "Unsupported format for " + name + ": " + formatName;
+					tokens.clear();
+					literals.clear();
+					return false;
+				}
+			}
+
+			Token token{};
+			token.type = TokenType::Value;
+			token.format = format;
+			token.valueIndex = static_cast<uint16_t>(variableIndex);
+
+			tokens.push_back(token);
+			i = end + 1;
+		}
+		else
+		{
+			// Escaped braces are written as a single character.
+			if ((c == '{' || c == '}') && (i + 1) < length && text[i + 1] == c)
+			{
+				i++;
+			}
+
+			// Adjacent literal characters are merged into one token.
+			if (tokens.empty() || tokens.back().type != TokenType::Literal)
+			{
+				Token token{};
+				token.type = TokenType::Literal;
+				token.literalOffset = static_cast<uint32_t>(literals.size());
+				token.literalLength = 0;
+
+				tokens.push_back(token);
+			}
+
+			literals.push_back(text[i]);
+			tokens.back().literalLength++;
+			i++;
+		}
+	}
+
+	return true;
+}
+
+bool StatusTemplate::IsEmpty() const
+{
+	return tokens.empty();
+}
+
+size_t StatusTemplate::Render(
+	const StatusTemplateValue* values,
+	size_t valueCount,
+	char* buffer,
+	size_t bufferSize) const
+{
+	if (!buffer || bufferSize == 0)
+	{
+		return 0;
+	}
+
+	OutputBuffer output(buffer, bufferSize);
+
+	for (const Token& token : tokens)
+	{
+		if (token.type == TokenType::Literal)
+		{
+			output.Append(literals.data() + token.literalOffset, token.literalLength);
+		}
+		else if (token.valueIndex < valueCount)
+		{
+			const StatusTemplateValue& value = values[token.valueIndex];
+
+			if (value.text)
+			{
+				output.Append(value.text, std::strlen(value.text));
+			}
+			else
+			{
+				output.AppendNumber(value.number, token.format);
+			}
+		}
+	}
+
+	return output.Finish();
+}
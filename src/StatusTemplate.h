@@ -0,0 +1,94 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-discord-rich-presence, a DLL Plugin for
+// SimCity 4 that implements Discord rich presence support.
+//
+// Copyright (c) 2024 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum class StatusTemplateFormat : uint8_t
+{
+	// A number with thousands separators, e.g. 1,234.
+	Number,
+	// A number with thousands separators and the simoleon symbol, e.g. §1,234.
+	Money,
+	// A number without any separators.
+	Raw,
+	// A text value.
+	Text,
+};
+
+struct StatusTemplateVariable
+{
+	const char* name;
+	StatusTemplateFormat defaultFormat;
+};
+
+struct StatusTemplateValue
+{
+	// The value is a number when text is null.
+	const char* text;
+	int64_t number;
+};
+
+// A user-defined status line, e.g. "{res_pop} Sims, {funds}".
+//
+// The template text is compiled once into a list of literal and value tokens,
+// rendering the template does not parse the text or allocate memory.
+//
+// A value is written as {name} or {name:format}, where format is number, money
+// or raw. Use {{ and }} for literal braces.
+class StatusTemplate
+{
+public:
+	StatusTemplate();
+
+	// Compiles the template, the variable indices are used to look up
+	// the values that are passed to Render.
+	// Returns false and sets errorMessage if the template is invalid.
+	bool Compile(
+		const std::string& text,
+		const StatusTemplateVariable* variables,
+		size_t variableCount,
+		std::string& errorMessage);
+
+	bool IsEmpty() const;
+
+	// Renders the template into the buffer, truncating it at a UTF-8 character
+	// boundary if it does not fit.
+	// Returns the length of the rendered text.
+	size_t Render(
+		const StatusTemplateValue* values,
+		size_t valueCount,
+		char* buffer,
+		size_t bufferSize) const;
+
+private:
+	enum class TokenType : uint8_t
+	{
+		Literal,
+		Value,
+	};
+
+	struct Token
+	{
+		TokenType type;
+		StatusTemplateFormat format;
+		uint16_t valueIndex;
+		uint32_t literalOffset;
+		uint32_t literalLength;
+	};
+
+	std::vector<Token> tokens;
+	std::string literals;
+};
@@ -0,0 +1,253 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-discord-rich-presence, a DLL Plugin for
+// SimCity 4 that implements Discord rich presence support.
+//
+// Copyright (c) 2024 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#include "TaskScheduler.h"
+#include <algorithm>
+#include <utility>
+
+ScheduledTask::ScheduledTask(std::coroutine_handle<promise_type> handle)
+	: handle(handle)
+{
+}
+
+ScheduledTask::ScheduledTask(ScheduledTask&& other) noexcept
+	: handle(std::exchange(other.handle, nullptr))
+{
+}
+
+ScheduledTask& ScheduledTask::operator=(ScheduledTask&& other) noexcept
+{
+	if (this != &other)
+	{
+		if (handle)
+		{
+			handle.destroy();
+		}
+
+		handle = std::exchange(other.handle, nullptr);
+	}
+
+	return *this;
+}
+
+ScheduledTask::~ScheduledTask()
+{
+	if (handle)
+	{
+		handle.destroy();
+	}
+}
+
+std::coroutine_handle<ScheduledTask::promise_type> ScheduledTask::Release()
+{
+	return std::exchange(handle, nullptr);
+}
+
+TaskScheduler::Awaiter::Awaiter(TaskScheduler& scheduler, WaitType type)
+	: scheduler(scheduler),
+	  type(type),
+	  delay(),
+	  messageType(0),
+	  condition(nullptr),
+	  pConditionContext(nullptr)
+{
+}
+
+bool TaskScheduler::Awaiter::await_ready() const noexcept
+{
+	switch (type)
+	{
+	case WaitType::Delay:
+		return delay <= Clock::duration::zero();
+	case WaitType::Condition:
+		return condition(pConditionContext);
+	case WaitType::Message:
+	default:
+		return false;
+	}
+}
+
+void TaskScheduler::Awaiter::await_suspend(std::coroutine_handle<> handle)
+{
+	scheduler.Suspend(*this, handle);
+}
+
+TaskScheduler::TaskScheduler()
+	: tasks(),
+	  waiters(),
+	  readyTasks(),
+	  currentTime()
+{
+}
+
+TaskScheduler::~TaskScheduler()
+{
+	Clear();
+}
+
+void TaskScheduler::Start(ScheduledTask task)
+{
+	std::coroutine_handle<ScheduledTask::promise_type> handle = task.Release();
+
+	if (handle)
+	{
+		tasks.push_back(handle);
+		handle.resume();
+
+		DestroyCompletedTasks();
+	}
+}
+
+void TaskScheduler::Tick(Clock::time_point now)
+{
+	currentTime = now;
+
+	for (auto it = waiters.begin(); it != waiters.end();)
+	{
+		bool ready = false;
+
+		if (it->type == Awaiter::WaitType::Delay)
+		{
+			ready = now >= it->resumeTime;
+		}
+		else if (it->type == Awaiter::WaitType::Condition)
+		{
+			ready = it->condition(it->pConditionContext);
+		}
+
+		if (ready)
+		{
+			readyTasks.push_back(it->handle);
+			it = waiters.erase(it);
+		}
+		else
+		{
+			++it;
+		}
+	}
+
+	ResumeReadyTasks();
+}
+
+void TaskScheduler::NotifyMessage(uint32_t messageType)
+{
+	for (auto it = waiters.begin(); it != waiters.end();)
+	{
+		if (it->type == Awaiter::WaitType::Message && it->messageType == messageType)
+		{
+			readyTasks.push_back(it->handle);
+			it = waiters.erase(it);
+		}
+		else
+		{
+			++it;
+		}
+	}
+
+	ResumeReadyTasks();
+}
+
+void TaskScheduler::Clear()
+{
+	waiters.clear();
+	readyTasks.clear();
+
+	for (auto& handle : tasks)
+	{
+		handle.destroy();
+	}
+
+	tasks.clear();
+}
+
+TaskScheduler::Awaiter TaskScheduler::Delay(Clock::duration duration)
+{
+	Awaiter awaiter(*this, Awaiter::WaitType::Delay);
+	awaiter.delay = duration;
+
+	return awaiter;
+}
+
+TaskScheduler::Awaiter TaskScheduler::WaitForMessage(uint32_t messageType)
+{
+	Awaiter awaiter(*this, Awaiter::WaitType::Message);
+	awaiter.messageType = messageType;
+
+	return awaiter;
+}
+
+TaskScheduler::Awaiter TaskScheduler::WaitUntil(ConditionCallback callback, void* pContext)
+{
+	Awaiter awaiter(*this, Awaiter::WaitType::Condition);
+	awaiter.condition = callback;
+	awaiter.pConditionContext = pContext;
+
+	return awaiter;
+}
+
+void TaskScheduler::Suspend(const Awaiter& awaiter, std::coroutine_handle<> handle)
+{
+	Waiter waiter{};
+	waiter.handle = handle;
+	waiter.type = awaiter.type;
+	waiter.resumeTime = currentTime + awaiter.delay;
+	waiter.messageType = awaiter.messageType;
+	waiter.condition = awaiter.condition;
+	waiter.pConditionContext = awaiter.pConditionContext;
+
+	waiters.push_back(waiter);
+}
+
+void TaskScheduler::ResumeReadyTasks()
+{
+	if (!readyTasks.empty())
+	{
+		// A resumed task can suspend again or complete, so the list of ready tasks
+		// is swapped out before any of them run.
+		std::vector<std::coroutine_handle<>> tasksToResume;
+		tasksToResume.swap(readyTasks);
+
+		for (auto& handle : tasksToResume)
+		{
+			handle.resume();
+		}
+
+		// Reuse the list's memory for the next tick.
+		tasksToResume.clear();
+
+		if (readyTasks.empty())
+		{
+			readyTasks.swap(tasksToResume);
+		}
+
+		DestroyCompletedTasks();
+	}
+}
+
+void TaskScheduler::DestroyCompletedTasks()
+{
+	auto it = std::remove_if(
+		tasks.begin(),
+		tasks.end(),
+		[](std::coroutine_handle<ScheduledTask::promise_type> handle)
+		{
+			if (handle.done())
+			{
+				handle.destroy();
+				return true;
+			}
+
+			return false;
+		});
+
+	tasks.erase(it, tasks.end());
+}
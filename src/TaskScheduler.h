@@ -0,0 +1,154 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-discord-rich-presence, a DLL Plugin for
+// SimCity 4 that implements Discord rich presence support.
+//
+// Copyright (c) 2024 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <vector>
+
+// A coroutine that is run by the TaskScheduler.
+// The coroutine does not start until it is passed to TaskScheduler::Start.
+class ScheduledTask
+{
+public:
+	struct promise_type
+	{
+		ScheduledTask get_return_object()
+		{
+			return ScheduledTask(std::coroutine_handle<promise_type>::from_promise(*this));
+		}
+
+		std::suspend_always initial_suspend() noexcept
+		{
+			return {};
+		}
+
+		std::suspend_always final_suspend() noexcept
+		{
+			return {};
+		}
+
+		void return_void()
+		{
+		}
+
+		void unhandled_exception()
+		{
+			std::terminate();
+		}
+	};
+
+	ScheduledTask(ScheduledTask&& other) noexcept;
+	ScheduledTask& operator=(ScheduledTask&& other) noexcept;
+	~ScheduledTask();
+
+	ScheduledTask(const ScheduledTask&) = delete;
+	ScheduledTask& operator=(const ScheduledTask&) = delete;
+
+	std::coroutine_handle<promise_type> Release();
+
+private:
+	explicit ScheduledTask(std::coroutine_handle<promise_type> handle);
+
+	std::coroutine_handle<promise_type> handle;
+};
+
+// Runs the ScheduledTask coroutines from the game's idle tick.
+//
+// A suspended task does no work until the condition that it is waiting on
+// is met, all tasks are resumed on the thread that calls Tick and NotifyMessage.
+class TaskScheduler
+{
+public:
+	typedef std::chrono::steady_clock Clock;
+	typedef bool(*ConditionCallback)(void* pContext);
+
+	class Awaiter
+	{
+	public:
+		bool await_ready() const noexcept;
+		void await_suspend(std::coroutine_handle<> handle);
+		void await_resume() const noexcept
+		{
+		}
+
+	private:
+		friend class TaskScheduler;
+
+		enum class WaitType
+		{
+			Delay,
+			Message,
+			Condition,
+		};
+
+		Awaiter(TaskScheduler& scheduler, WaitType type);
+
+		TaskScheduler& scheduler;
+		WaitType type;
+		Clock::duration delay;
+		uint32_t messageType;
+		ConditionCallback condition;
+		void* pConditionContext;
+	};
+
+	TaskScheduler();
+	~TaskScheduler();
+
+	TaskScheduler(const TaskScheduler&) = delete;
+	TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+	// Runs the task until it first suspends.
+	void Start(ScheduledTask task);
+
+	// Resumes the tasks whose delay has elapsed or whose condition is true.
+	// The delays are measured from the time of the most recent tick, the
+	// scheduler does not read the clock itself.
+	void Tick(Clock::time_point now);
+
+	// Resumes the tasks that are waiting for the specified message.
+	void NotifyMessage(uint32_t messageType);
+
+	// Destroys all of the tasks, including the suspended ones.
+	void Clear();
+
+	// Resumes the task after the specified duration.
+	Awaiter Delay(Clock::duration duration);
+
+	// Resumes the task when the message is passed to NotifyMessage.
+	Awaiter WaitForMessage(uint32_t messageType);
+
+	// Resumes the task from Tick once the callback returns true.
+	Awaiter WaitUntil(ConditionCallback callback, void* pContext);
+
+private:
+	struct Waiter
+	{
+		std::coroutine_handle<> handle;
+		Awaiter::WaitType type;
+		Clock::time_point resumeTime;
+		uint32_t messageType;
+		ConditionCallback condition;
+		void* pConditionContext;
+	};
+
+	void Suspend(const Awaiter& awaiter, std::coroutine_handle<> handle);
+	void ResumeReadyTasks();
+	void DestroyCompletedTasks();
+
+	std::vector<std::coroutine_handle<ScheduledTask::promise_type>> tasks;
+	std::vector<Waiter> waiters;
+	std::vector<std::coroutine_handle<>> readyTasks;
+	Clock::time_point currentTime;
+};
@@ -0,0 +1,217 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-discord-rich-presence, a DLL Plugin for
+// SimCity 4 that implements Discord rich presence support.
+//
+// Copyright (c) 2024 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#include "Utf8Text.h"
+#include <cstdint>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__)
+#define UTF8_TEXT_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+	// The Unicode code points of the Windows-1252 characters in the 0x80 to 0x9F range,
+	// the unused values are mapped to the replacement character.
+	constexpr uint16_t Windows1252HighControlRange[32] =
+	{
+		0x20AC, 0xFFFD, 0x201A, 0x0192, 0x201E, 0x2026, 0x2020, 0x2021,
+		0x02C6, 0x2030, 0x0160, 0x2039, 0x0152, 0xFFFD, 0x017D, 0xFFFD,
+		0xFFFD, 0x2018, 0x2019, 0x201C, 0x201D, 0x2022, 0x2013, 0x2014,
+		0x02DC, 0x2122, 0x0161, 0x203A, 0x0153, 0xFFFD, 0x017E, 0x0178,
+	};
+
+	inline bool IsContinuationByte(uint8_t value)
+	{
+		return (value & 0xC0) == 0x80;
+	}
+
+	// Returns the number of leading ASCII bytes.
+	size_t SkipAscii(const uint8_t* text, size_t length)
+	{
+		size_t i = 0;
+
+#if UTF8_TEXT_SSE2
+		while ((i + 16) <= length)
+		{
+			const __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i));
+
+			// The high bit is only set for the bytes that are part of a multi-byte sequence.
+			if (_mm_movemask_epi8(values) != 0)
+			{
+				break;
+			}
+
+			i += 16;
+		}
+#endif // UTF8_TEXT_SSE2
+
+		while (i < length && text[i] < 0x80)
+		{
+			i++;
+		}
+
+		return i;
+	}
+
+	void AppendCodePoint(std::string& output, uint32_t codePoint)
+	{
+		if (codePoint < 0x80)
+		{
+			output.push_back(static_cast<char>(codePoint));
+		}
+		else if (codePoint < 0x800)
+		{
+			output.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+			output.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+		}
+		else
+		{
+			output.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+			output.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+			output.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+		}
+	}
+}
+
+bool Utf8Text::IsValid(const char* text, size_t length)
+{
+	const uint8_t* bytes = reinterpret_cast<const uint8_t*>(text);
+	size_t i = 0;
+
+	while (i < length)
+	{
+		i += SkipAscii(bytes + i, length - i);
+
+		if (i >= length)
+		{
+			break;
+		}
+
+		const uint8_t lead = bytes[i];
+		size_t sequenceLength = 0;
+		// The valid range of the second byte, which excludes the overlong encodings,
+		// the UTF-16 surrogates and the values above U+10FFFF.
+		uint8_t minSecond = 0x80;
+		uint8_t maxSecond = 0xBF;
+
+		if (lead >= 0xC2 && lead <= 0xDF)
+		{
+			sequenceLength = 2;
+		}
+		else if (lead >= 0xE0 && lead <= 0xEF)
+		{
+			sequenceLength = 3;
+
+			if (lead == 0xE0)
+			{
+				minSecond = 0xA0;
+			}
+			else if (lead == 0xED)
+			{
+				maxSecond = 0x9F;
+			}
+		}
+		else if (lead >= 0xF0 && lead <= 0xF4)
+		{
+			sequenceLength = 4;
+
+			if (lead == 0xF0)
+			{
+				minSecond = 0x90;
+			}
+			else if (lead == 0xF4)
+			{
+				maxSecond = 0x8F;
+			}
+		}
+		else
+		{
+			return false;
+		}
+
+		if ((length - i) < sequenceLength)
+		{
+			return false;
+		}
+
+		const uint8_t second = bytes[i + 1];
+
+		if (second < minSecond || second > maxSecond)
+		{
+			return false;
+		}
+
+		for (size_t j = 2; j < sequenceLength; j++)
+		{
+			if (!IsContinuationByte(bytes[i + j]))
+			{
+				return false;
+			}
+		}
+
+		i += sequenceLength;
+	}
+
+	return true;
+}
+
+std::string Utf8Text::FromWindows1252(const char* text, size_t length)
+{
+	std::string output;
+	output.reserve(length * 2);
+
+	for (size_t i = 0; i < length; i++)
+	{
+		const uint8_t value = static_cast<uint8_t>(text[i]);
+
+		if (value >= 0x80 && value <= 0x9F)
+		{
+			AppendCodePoint(output, Windows1252HighControlRange[value - 0x80]);
+		}
+		else
+		{
+			// The other Windows-1252 values are the same as the Unicode code points.
+			AppendCodePoint(output, value);
+		}
+	}
+
+	return output;
+}
+
+std::string Utf8Text::ToValidUtf8(const char* text, size_t length)
+{
+	if (IsValid(text, length))
+	{
+		return std::string(text, length);
+	}
+
+	return FromWindows1252(text, length);
+}
+
+size_t Utf8Text::FindTruncationPoint(const char* text, size_t length, size_t maxLength)
+{
+	if (length <= maxLength)
+	{
+		return length;
+	}
+
+	size_t end = maxLength;
+
+	// Back up to the start of the sequence that would be split.
+	while (end > 0 && IsContinuationByte(static_cast<uint8_t>(text[end])))
+	{
+		end--;
+	}
+
+	return end;
+}
@@ -0,0 +1,32 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-discord-rich-presence, a DLL Plugin for
+// SimCity 4 that implements Discord rich presence support.
+//
+// Copyright (c) 2024 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <cstddef>
+#include <string>
+
+// UTF-8 is SC4's native string encoding, but the names in older saves
+// may use the Windows-1252 code page.
+namespace Utf8Text
+{
+	bool IsValid(const char* text, size_t length);
+
+	// Converts Windows-1252 text to UTF-8.
+	std::string FromWindows1252(const char* text, size_t length);
+
+	// Returns the text as UTF-8, the text is treated as Windows-1252 if it is not valid UTF-8.
+	std::string ToValidUtf8(const char* text, size_t length);
+
+	// Returns the largest length that is less than or equal to maxLength and does not
+	// split a UTF-8 sequence.
+	size_t FindTruncationPoint(const char* text, size_t length, size_t maxLength);
+}
@@ -0,0 +1,112 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-discord-rich-presence, a DLL Plugin for
+// SimCity 4 that implements Discord rich presence support.
+//
+// Copyright (c) 2024 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include "cIGZUnknown.h"
+#include <cstdint>
+
+// This header can be used by other plugins to read the city and region statistics
+// that this plugin tracks, without querying the game's simulators again.
+//
+// The interface is retrieved from the plugin's system service:
+//
+// cIDiscordPresenceStats* pStats = nullptr;
+// if (pFramework->GetSystemService(kDiscordRichPresenceServiceID, GZIID_cIDiscordPresenceStats, reinterpret_cast<void**>(&pStats)))
+// {
+//     cIDiscordPresenceSnapshot* pSnapshot = nullptr;
+//     if (pStats->GetSnapshot(&pSnapshot))
+//     {
+//         ...
+//         pSnapshot->Release();
+//     }
+//     pStats->Release();
+// }
+
+static const uint32_t kDiscordRichPresenceServiceID = 0xFE95AAEA;
+
+static const uint32_t GZIID_cIDiscordPresenceStats = 0x3C6F9B21;
+static const uint32_t GZIID_cIDiscordPresenceSnapshot = 0x3C6F9B22;
+
+enum class DiscordPresenceView : uint32_t
+{
+	None,
+	Region,
+	EstablishedCity,
+	UnestablishedCity,
+};
+
+struct DiscordPresenceCityStats
+{
+	int64_t totalFunds;
+	int32_t residentialPopulation;
+	int32_t commercialPopulation;
+	int32_t industrialPopulation;
+	int32_t mayorRating;
+	int32_t cityAgeInYears;
+	int32_t monthlyNetIncome;
+	int32_t averageAirPollution;
+	int32_t averageWaterPollution;
+	int32_t averagePoliceCoverage;
+	int32_t averageAura;
+	int32_t lotCount;
+	int32_t buildingCount;
+	int32_t landmarkCount;
+	int32_t criminalCount;
+};
+
+struct DiscordPresenceRegionStats
+{
+	int64_t totalResidentialPopulation;
+	int64_t totalCommercialJobs;
+	int64_t totalIndustrialJobs;
+	int64_t totalFunds;
+	int64_t developedCellCount;
+	uint32_t totalCities;
+	uint32_t developedCityCount;
+	uint32_t undevelopedCityCount;
+	uint32_t borderingCityCount;
+	uint32_t standaloneCityCount;
+	uint32_t developedLandPercentage;
+	uint32_t cityClusterCount;
+	uint32_t largestCityClusterSize;
+};
+
+// An immutable set of statistics.
+// The snapshot remains valid until it is released, even after a newer snapshot
+// has been published. It can be read from any thread without locking.
+class cIDiscordPresenceSnapshot : public cIGZUnknown
+{
+public:
+	// The version increases each time a snapshot with different values is published.
+	virtual uint32_t GetVersion() const = 0;
+
+	virtual DiscordPresenceView GetView() const = 0;
+
+	// Returns nullptr if the view is not an established city.
+	virtual const DiscordPresenceCityStats* GetCityStats() const = 0;
+
+	// The strings are UTF-8, and they are empty if the value is not available.
+	virtual const char* GetCityName() const = 0;
+	virtual const char* GetMayorName() const = 0;
+	virtual const char* GetRegionName() const = 0;
+
+	// The statistics of the region that was most recently loaded.
+	virtual const DiscordPresenceRegionStats* GetRegionStats() const = 0;
+};
+
+class cIDiscordPresenceStats : public cIGZUnknown
+{
+public:
+	// Gets the current snapshot, the caller must Release it.
+	// This must be called from the game's main thread.
+	virtual bool GetSnapshot(cIDiscordPresenceSnapshot** ppSnapshot) = 0;
+};
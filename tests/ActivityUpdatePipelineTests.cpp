@@ -0,0 +1,271 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-discord-rich-presence, a DLL Plugin for
+// SimCity 4 that implements Discord rich presence support.
+//
+// Copyright (c) 2024 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#include "ActivityUpdatePipeline.h"
+#include "FakePresenceClock.h"
+#include "TestAssert.h"
+#include <string>
+
+namespace
+{
+	class FakeActivitySender final : public IDiscordActivitySender
+	{
+	public:
+		FakeActivitySender()
+			: ready(true),
+			  sendFails(false),
+			  sendCount(0),
+			  nextRequestId(1),
+			  lastState()
+		{
+		}
+
+		bool IsReady() const override
+		{
+			return ready;
+		}
+
+		uint64_t UpdateActivity(const DiscordActivity& activity) override
+		{
+			sendCount++;
+
+			if (sendFails)
+			{
+				return 0;
+			}
+
+			lastState = activity.GetState();
+			return nextRequestId++;
+		}
+
+		bool ready;
+		bool sendFails;
+		uint32_t sendCount;
+		uint64_t nextRequestId;
+		std::string lastState;
+	};
+
+	DiscordActivity MakeActivity(const char* state)
+	{
+		DiscordActivity activity;
+		activity.SetState(state);
+
+		return activity;
+	}
+
+	// Returns the time until the pipeline can send again, in whole milliseconds.
+	int64_t MeasureDelay(ActivityUpdatePipeline& pipeline, FakePresenceClock& clock)
+	{
+		int64_t delay = 0;
+
+		while (!pipeline.CanSend() && delay < 1000000)
+		{
+			clock.Advance(std::chrono::milliseconds(1));
+			delay++;
+		}
+
+		return delay;
+	}
+
+	void SendsThePendingActivity()
+	{
+		FakePresenceClock clock;
+		FakeActivitySender sender;
+		ActivityUpdatePipeline pipeline(sender, clock);
+
+		pipeline.Send();
+		CHECK(sender.sendCount == 0);
+
+		pipeline.Submit(MakeActivity("first"));
+		pipeline.Send();
+
+		CHECK(sender.sendCount == 1);
+		CHECK(sender.lastState == "first");
+		CHECK(!pipeline.CanSend());
+	}
+
+	void WaitsUntilTheClientIsReady()
+	{
+		FakePresenceClock clock;
+		FakeActivitySender sender;
+		ActivityUpdatePipeline pipeline(sender, clock);
+
+		sender.ready = false;
+		pipeline.Submit(MakeActivity("first"));
+		pipeline.Send();
+
+		CHECK(!pipeline.CanSend());
+		CHECK(sender.sendCount == 0);
+
+		sender.ready = true;
+		pipeline.Send();
+
+		CHECK(sender.sendCount == 1);
+	}
+
+	void CoalescesActivitiesWhileInFlight()
+	{
+		FakePresenceClock clock;
+		FakeActivitySender sender;
+		ActivityUpdatePipeline pipeline(sender, clock);
+
+		pipeline.Submit(MakeActivity("first"));
+		pipeline.Send();
+
+		pipeline.Submit(MakeActivity("second"));
+		pipeline.Send();
+		pipeline.Submit(MakeActivity("third"));
+		pipeline.Send();
+
+		CHECK(sender.sendCount == 1);
+
+		pipeline.RequestCompleted(1, DiscordRequestResult::Ok);
+		pipeline.Send();
+
+		// The rate limit still applies after the response.
+		CHECK(sender.sendCount == 1);
+
+		clock.Advance(std::chrono::seconds(5));
+		pipeline.Send();
+
+		CHECK(sender.sendCount == 2);
+		CHECK(sender.lastState == "third");
+	}
+
+	void IgnoresUnknownRequestIds()
+	{
+		FakePresenceClock clock;
+		FakeActivitySender sender;
+		ActivityUpdatePipeline pipeline(sender, clock);
+
+		pipeline.Submit(MakeActivity("first"));
+		pipeline.Send();
+
+		pipeline.RequestCompleted(0, DiscordRequestResult::Ok);
+		pipeline.RequestCompleted(42, DiscordRequestResult::Ok);
+
+		clock.Advance(std::chrono::seconds(5));
+		CHECK(!pipeline.CanSend());
+
+		pipeline.RequestCompleted(1, DiscordRequestResult::Ok);
+		CHECK(pipeline.CanSend());
+	}
+
+	void FailedRequestsBackOffExponentially()
+	{
+		FakePresenceClock clock;
+		FakeActivitySender sender;
+		ActivityUpdatePipeline pipeline(sender, clock);
+
+		pipeline.Submit(MakeActivity("first"));
+
+		// The delay doubles from 5 seconds up to 60 seconds, and up to half
+		// of the delay is added as jitter.
+		const int64_t expectedDelays[] = { 5000, 10000, 20000, 40000, 60000, 60000 };
+
+		for (int64_t expectedDelay : expectedDelays)
+		{
+			pipeline.Send();
+
+			const uint64_t requestId = sender.nextRequestId - 1;
+			pipeline.RequestCompleted(requestId, DiscordRequestResult::TimedOut);
+
+			const int64_t delay = MeasureDelay(pipeline, clock);
+
+			CHECK(delay >= expectedDelay);
+			CHECK(delay <= expectedDelay + (expectedDelay / 2));
+		}
+
+		// The failed activity is sent again.
+		pipeline.Send();
+		CHECK(sender.sendCount == 7);
+		CHECK(sender.lastState == "first");
+
+		// A success resets the backoff to the rate limit.
+		pipeline.RequestCompleted(sender.nextRequestId - 1, DiscordRequestResult::Ok);
+		pipeline.Submit(MakeActivity("second"));
+
+		CHECK(MeasureDelay(pipeline, clock) <= 5000);
+	}
+
+	void NewerActivityReplacesTheFailedOne()
+	{
+		FakePresenceClock clock;
+		FakeActivitySender sender;
+		ActivityUpdatePipeline pipeline(sender, clock);
+
+		pipeline.Submit(MakeActivity("first"));
+		pipeline.Send();
+		pipeline.Submit(MakeActivity("second"));
+		pipeline.RequestCompleted(1, DiscordRequestResult::DiscordError);
+
+		MeasureDelay(pipeline, clock);
+		pipeline.Send();
+
+		CHECK(sender.sendCount == 2);
+		CHECK(sender.lastState == "second");
+	}
+
+	void SendFailureKeepsThePendingActivity()
+	{
+		FakePresenceClock clock;
+		FakeActivitySender sender;
+		ActivityUpdatePipeline pipeline(sender, clock);
+
+		sender.sendFails = true;
+		pipeline.Submit(MakeActivity("first"));
+		pipeline.Send();
+
+		CHECK(sender.sendCount == 1);
+		CHECK(!pipeline.CanSend());
+
+		const int64_t delay = MeasureDelay(pipeline, clock);
+		CHECK(delay >= 5000 && delay <= 7500);
+
+		sender.sendFails = false;
+		pipeline.Send();
+
+		CHECK(sender.sendCount == 2);
+		CHECK(sender.lastState == "first");
+	}
+
+	void ResetDiscardsTheBackoff()
+	{
+		FakePresenceClock clock;
+		FakeActivitySender sender;
+		ActivityUpdatePipeline pipeline(sender, clock);
+
+		pipeline.Submit(MakeActivity("first"));
+		pipeline.Send();
+		pipeline.RequestCompleted(1, DiscordRequestResult::Disconnected);
+
+		CHECK(!pipeline.CanSend());
+
+		pipeline.Reset();
+
+		CHECK(pipeline.CanSend());
+	}
+}
+
+int main()
+{
+	RUN_TEST(SendsThePendingActivity);
+	RUN_TEST(WaitsUntilTheClientIsReady);
+	RUN_TEST(CoalescesActivitiesWhileInFlight);
+	RUN_TEST(IgnoresUnknownRequestIds);
+	RUN_TEST(FailedRequestsBackOffExponentially);
+	RUN_TEST(NewerActivityReplacesTheFailedOne);
+	RUN_TEST(SendFailureKeepsThePendingActivity);
+	RUN_TEST(ResetDiscardsTheBackoff);
+
+	return GetTestFailureCount();
+}
@@ -0,0 +1,179 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-discord-rich-presence, a DLL Plugin for
+// SimCity 4 that implements Discord rich presence support.
+//
+// Copyright (c) 2024 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#include "BuildingCounter.h"
+#include "TestAssert.h"
+#include <random>
+#include <vector>
+
+namespace
+{
+	constexpr uint32_t PropOccupantType = 0x274376B0;
+	constexpr uint32_t FloraOccupantType = 0x74758926;
+
+	// A stand-in for the city's occupant manager that sends the insert and
+	// remove notifications to the counter.
+	class FakeCity
+	{
+	public:
+		explicit FakeCity(BuildingCounter& counter)
+			: counter(counter),
+			  occupantTypes()
+		{
+		}
+
+		void Insert(uint32_t occupantType)
+		{
+			occupantTypes.push_back(occupantType);
+			counter.OccupantInserted(occupantType);
+		}
+
+		void Remove(size_t index)
+		{
+			const uint32_t occupantType = occupantTypes[index];
+
+			occupantTypes.erase(occupantTypes.begin() + index);
+			counter.OccupantRemoved(occupantType);
+		}
+
+		size_t GetOccupantCount() const
+		{
+			return occupantTypes.size();
+		}
+
+		// Counts the buildings in the same way as the scan that seeds the counter.
+		int32_t ScanBuildings() const
+		{
+			int32_t count = 0;
+
+			for (uint32_t occupantType : occupantTypes)
+			{
+				if (occupantType == BuildingCounter::BuildingOccupantType)
+				{
+					count++;
+				}
+			}
+
+			return count;
+		}
+
+	private:
+		BuildingCounter& counter;
+		std::vector<uint32_t> occupantTypes;
+	};
+
+	void IgnoresMessagesUntilStarted()
+	{
+		BuildingCounter counter;
+		FakeCity city(counter);
+
+		// The game inserts the saved occupants while loading the city.
+		city.Insert(BuildingCounter::BuildingOccupantType);
+		city.Insert(BuildingCounter::BuildingOccupantType);
+		CHECK(counter.GetCount() == 0);
+
+		counter.Start(city.ScanBuildings());
+		CHECK(counter.GetCount() == 2);
+	}
+
+	void OnlyBuildingsAreCounted()
+	{
+		BuildingCounter counter;
+		counter.Start(0);
+
+		CHECK(counter.OccupantInserted(BuildingCounter::BuildingOccupantType));
+		CHECK(!counter.OccupantInserted(PropOccupantType));
+		CHECK(!counter.OccupantRemoved(FloraOccupantType));
+		CHECK(counter.GetCount() == 1);
+
+		CHECK(counter.OccupantRemoved(BuildingCounter::BuildingOccupantType));
+		CHECK(!counter.OccupantRemoved(BuildingCounter::BuildingOccupantType));
+		CHECK(counter.GetCount() == 0);
+	}
+
+	void StopIgnoresTheCityShutdown()
+	{
+		BuildingCounter counter;
+		FakeCity city(counter);
+
+		counter.Start(0);
+		city.Insert(BuildingCounter::BuildingOccupantType);
+		city.Insert(BuildingCounter::BuildingOccupantType);
+
+		counter.Stop();
+
+		while (city.GetOccupantCount() > 0)
+		{
+			city.Remove(0);
+		}
+
+		CHECK(counter.GetCount() == 2);
+	}
+
+	void MatchesAFullRescan()
+	{
+		const uint32_t occupantTypes[] =
+		{
+			BuildingCounter::BuildingOccupantType,
+			PropOccupantType,
+			FloraOccupantType,
+		};
+
+		std::mt19937 random(12345);
+		std::uniform_int_distribution<int> actionDistribution(0, 1);
+		std::uniform_int_distribution<int> typeDistribution(0, 2);
+
+		BuildingCounter counter;
+		FakeCity city(counter);
+
+		for (int i = 0; i < 500; i++)
+		{
+			city.Insert(occupantTypes[typeDistribution(random)]);
+		}
+
+		counter.Start(city.ScanBuildings());
+
+		int mismatches = 0;
+
+		for (int iteration = 0; iteration < 20000; iteration++)
+		{
+			// Inserts and removals are equally likely, so the city size stays
+			// around the starting size.
+			if (actionDistribution(random) == 0 || city.GetOccupantCount() == 0)
+			{
+				city.Insert(occupantTypes[typeDistribution(random)]);
+			}
+			else
+			{
+				std::uniform_int_distribution<size_t> indexDistribution(0, city.GetOccupantCount() - 1);
+				city.Remove(indexDistribution(random));
+			}
+
+			if (counter.GetCount() != city.ScanBuildings())
+			{
+				mismatches++;
+			}
+		}
+
+		CHECK(mismatches == 0);
+	}
+}
+
+int main()
+{
+	RUN_TEST(IgnoresMessagesUntilStarted);
+	RUN_TEST(OnlyBuildingsAreCounted);
+	RUN_TEST(StopIgnoresTheCityShutdown);
+	RUN_TEST(MatchesAFullRescan);
+
+	return GetTestFailureCount();
+}
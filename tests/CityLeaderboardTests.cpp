@@ -0,0 +1,108 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-discord-rich-presence, a DLL Plugin for
+// SimCity 4 that implements Discord rich presence support.
+//
+// Copyright (c) 2024 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#include "CityLeaderboard.h"
+#include "TestAssert.h"
+
+namespace
+{
+	bool HasLeader(const CityLeaderboard& leaderboard, uint32_t cityId, int64_t value)
+	{
+		CityLeaderboard::Entry entry{};
+
+		return leaderboard.GetLeader(entry) && entry.cityId == cityId && entry.value == value;
+	}
+
+	void EmptyLeaderboardHasNoLeader()
+	{
+		CityLeaderboard leaderboard;
+		CityLeaderboard::Entry entry{};
+
+		CHECK(!leaderboard.GetLeader(entry));
+		CHECK(leaderboard.GetCount() == 0);
+	}
+
+	void LeaderHasTheHighestValue()
+	{
+		CityLeaderboard leaderboard;
+
+		leaderboard.Update(1, 500);
+		leaderboard.Update(2, 1500);
+		leaderboard.Update(3, 1000);
+
+		CHECK(leaderboard.GetCount() == 3);
+		CHECK(HasLeader(leaderboard, 2, 1500));
+	}
+
+	void DecreasedValueMovesTheLeader()
+	{
+		CityLeaderboard leaderboard;
+
+		leaderboard.Update(1, 500);
+		leaderboard.Update(2, 1500);
+		leaderboard.Update(3, 1000);
+
+		leaderboard.Update(2, 100);
+
+		CHECK(leaderboard.GetCount() == 3);
+		CHECK(HasLeader(leaderboard, 3, 1000));
+
+		leaderboard.Update(1, 2000);
+		CHECK(HasLeader(leaderboard, 1, 2000));
+	}
+
+	void TiesAreOrderedByCityId()
+	{
+		CityLeaderboard leaderboard;
+
+		leaderboard.Update(7, 100);
+		leaderboard.Update(3, 100);
+		leaderboard.Update(5, 100);
+
+		CHECK(HasLeader(leaderboard, 3, 100));
+
+		// An unchanged value does not move the city.
+		leaderboard.Update(3, 100);
+		CHECK(leaderboard.GetCount() == 3);
+		CHECK(HasLeader(leaderboard, 3, 100));
+	}
+
+	void RemovedCityIsNotRanked()
+	{
+		CityLeaderboard leaderboard;
+
+		leaderboard.Update(1, 500);
+		leaderboard.Update(2, 1500);
+
+		leaderboard.Remove(2);
+		leaderboard.Remove(42);
+
+		CHECK(leaderboard.GetCount() == 1);
+		CHECK(HasLeader(leaderboard, 1, 500));
+
+		leaderboard.Remove(1);
+
+		CityLeaderboard::Entry entry{};
+		CHECK(!leaderboard.GetLeader(entry));
+	}
+}
+
+int main()
+{
+	RUN_TEST(EmptyLeaderboardHasNoLeader);
+	RUN_TEST(LeaderHasTheHighestValue);
+	RUN_TEST(DecreasedValueMovesTheLeader);
+	RUN_TEST(TiesAreOrderedByCityId);
+	RUN_TEST(RemovedCityIsNotRanked);
+
+	return GetTestFailureCount();
+}
@@ -0,0 +1,162 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-discord-rich-presence, a DLL Plugin for
+// SimCity 4 that implements Discord rich presence support.
+//
+// Copyright (c) 2024 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#include "DisjointSet.h"
+#include "TestAssert.h"
+#include <random>
+
+namespace
+{
+	void ElementsStartInTheirOwnSets()
+	{
+		DisjointSet set;
+		set.Reset(4);
+
+		for (uint32_t i = 0; i < 4; i++)
+		{
+			CHECK(set.Find(i) == i);
+			CHECK(set.GetSetSize(i) == 1);
+		}
+	}
+
+	void UnionMergesTheSets()
+	{
+		DisjointSet set;
+		set.Reset(6);
+
+		CHECK(set.Union(0, 1));
+		CHECK(set.Union(2, 3));
+		CHECK(set.Union(1, 3));
+
+		// The elements are already in the same set.
+		CHECK(!set.Union(0, 2));
+		CHECK(!set.Union(4, 4));
+
+		CHECK(set.Find(0) == set.Find(3));
+		CHECK(set.Find(4) != set.Find(0));
+		CHECK(set.GetSetSize(2) == 4);
+		CHECK(set.GetSetSize(4) == 1);
+		CHECK(set.GetSetSize(5) == 1);
+	}
+
+	void ResetSeparatesTheElements()
+	{
+		DisjointSet set;
+		set.Reset(3);
+		set.Union(0, 1);
+		set.Union(1, 2);
+
+		set.Reset(5);
+
+		for (uint32_t i = 0; i < 5; i++)
+		{
+			CHECK(set.Find(i) == i);
+			CHECK(set.GetSetSize(i) == 1);
+		}
+	}
+
+	void AddAppendsASeparateElement()
+	{
+		DisjointSet set;
+		set.Reset(2);
+		set.Union(0, 1);
+
+		const uint32_t element = set.Add();
+
+		CHECK(element == 2);
+		CHECK(set.GetElementCount() == 3);
+		CHECK(set.Find(element) == element);
+		CHECK(set.GetSetSize(element) == 1);
+		CHECK(set.Union(element, 0));
+		CHECK(set.GetSetSize(1) == 3);
+	}
+
+	void MatchesAReferenceLabeling()
+	{
+		constexpr uint32_t ElementCount = 200;
+
+		std::mt19937 random(12345);
+		std::uniform_int_distribution<uint32_t> elementDistribution(0, ElementCount - 1);
+
+		DisjointSet set;
+		set.Reset(ElementCount);
+
+		// The reference relabels every element of the merged set.
+		uint32_t labels[ElementCount];
+
+		for (uint32_t i = 0; i < ElementCount; i++)
+		{
+			labels[i] = i;
+		}
+
+		int mismatches = 0;
+
+		for (int iteration = 0; iteration < 150; iteration++)
+		{
+			const uint32_t a = elementDistribution(random);
+			const uint32_t b = elementDistribution(random);
+
+			const uint32_t oldLabel = labels[b];
+			const uint32_t newLabel = labels[a];
+			const bool expectedMerge = newLabel != oldLabel;
+
+			for (uint32_t& label : labels)
+			{
+				if (label == oldLabel)
+				{
+					label = newLabel;
+				}
+			}
+
+			if (set.Union(a, b) != expectedMerge)
+			{
+				mismatches++;
+			}
+		}
+
+		for (uint32_t i = 0; i < ElementCount; i++)
+		{
+			uint32_t expectedSize = 0;
+
+			for (uint32_t j = 0; j < ElementCount; j++)
+			{
+				if (labels[j] == labels[i])
+				{
+					expectedSize++;
+				}
+
+				if ((labels[i] == labels[j]) != (set.Find(i) == set.Find(j)))
+				{
+					mismatches++;
+				}
+			}
+
+			if (set.GetSetSize(i) != expectedSize)
+			{
+				mismatches++;
+			}
+		}
+
+		CHECK(mismatches == 0);
+	}
+}
+
+int main()
+{
+	RUN_TEST(ElementsStartInTheirOwnSets);
+	RUN_TEST(UnionMergesTheSets);
+	RUN_TEST(ResetSeparatesTheElements);
+	RUN_TEST(AddAppendsASeparateElement);
+	RUN_TEST(MatchesAReferenceLabeling);
+
+	return GetTestFailureCount();
+}
@@ -0,0 +1,46 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-discord-rich-presence, a DLL Plugin for
+// SimCity 4 that implements Discord rich presence support.
+//
+// Copyright (c) 2024 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include "PresenceClock.h"
+
+// A PresenceClock that only moves when the test advances it.
+class FakePresenceClock final : public PresenceClock
+{
+public:
+	FakePresenceClock()
+		: steadyTime(std::chrono::hours(1)),
+		  systemTime(std::chrono::seconds(1700000000))
+	{
+	}
+
+	SteadyTimePoint GetSteadyTime() const override
+	{
+		return steadyTime;
+	}
+
+	SystemTimePoint GetSystemTime() const override
+	{
+		return systemTime;
+	}
+
+	template <typename Rep, typename Period>
+	void Advance(std::chrono::duration<Rep, Period> duration)
+	{
+		steadyTime += std::chrono::duration_cast<std::chrono::steady_clock::duration>(duration);
+		systemTime += std::chrono::duration_cast<std::chrono::system_clock::duration>(duration);
+	}
+
+private:
+	SteadyTimePoint steadyTime;
+	SystemTimePoint systemTime;
+};
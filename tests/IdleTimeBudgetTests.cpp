@@ -0,0 +1,106 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-discord-rich-presence, a DLL Plugin for
+// SimCity 4 that implements Discord rich presence support.
+//
+// Copyright (c) 2024 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#include "FakePresenceClock.h"
+#include "IdleTimeBudget.h"
+#include "TestAssert.h"
+
+namespace
+{
+	void RunTicks(IdleTimeBudget& budget, FakePresenceClock& clock, uint32_t count, std::chrono::microseconds duration)
+	{
+		for (uint32_t i = 0; i < count; i++)
+		{
+			budget.BeginTick();
+			clock.Advance(duration);
+			budget.EndTick();
+		}
+	}
+
+	void HasTimeRemainingUsesTheTickStart()
+	{
+		FakePresenceClock clock;
+		IdleTimeBudget budget(std::chrono::microseconds(500), clock);
+
+		budget.BeginTick();
+		CHECK(budget.HasTimeRemaining());
+
+		clock.Advance(std::chrono::microseconds(499));
+		CHECK(budget.HasTimeRemaining());
+
+		clock.Advance(std::chrono::microseconds(1));
+		CHECK(!budget.HasTimeRemaining());
+
+		budget.EndTick();
+		budget.BeginTick();
+		CHECK(budget.HasTimeRemaining());
+	}
+
+	void ZeroBudgetDisablesTheLimit()
+	{
+		FakePresenceClock clock;
+		IdleTimeBudget budget(std::chrono::microseconds::zero(), clock);
+
+		budget.BeginTick();
+		clock.Advance(std::chrono::seconds(1));
+		CHECK(budget.HasTimeRemaining());
+		budget.EndTick();
+
+		RunTicks(budget, clock, 200, std::chrono::seconds(1));
+		CHECK(!budget.IsDegraded());
+	}
+
+	void DegradesAfterAWindowWithTooManyOverruns()
+	{
+		FakePresenceClock clock;
+		IdleTimeBudget budget(std::chrono::microseconds(500), clock);
+
+		// 9 of the 100 ticks in the window are over budget.
+		RunTicks(budget, clock, 9, std::chrono::microseconds(600));
+		RunTicks(budget, clock, 91, std::chrono::microseconds(100));
+		CHECK(!budget.IsDegraded());
+
+		// The mode only changes at the end of a window.
+		RunTicks(budget, clock, 10, std::chrono::microseconds(600));
+		CHECK(!budget.IsDegraded());
+
+		RunTicks(budget, clock, 90, std::chrono::microseconds(100));
+		CHECK(budget.IsDegraded());
+	}
+
+	void RecoversAfterAWindowWithoutOverruns()
+	{
+		FakePresenceClock clock;
+		IdleTimeBudget budget(std::chrono::microseconds(500), clock);
+
+		RunTicks(budget, clock, 100, std::chrono::microseconds(600));
+		CHECK(budget.IsDegraded());
+
+		// A single overrun keeps the degraded mode.
+		RunTicks(budget, clock, 1, std::chrono::microseconds(600));
+		RunTicks(budget, clock, 99, std::chrono::microseconds(100));
+		CHECK(budget.IsDegraded());
+
+		RunTicks(budget, clock, 100, std::chrono::microseconds(100));
+		CHECK(!budget.IsDegraded());
+	}
+}
+
+int main()
+{
+	RUN_TEST(HasTimeRemainingUsesTheTickStart);
+	RUN_TEST(ZeroBudgetDisablesTheLimit);
+	RUN_TEST(DegradesAfterAWindowWithTooManyOverruns);
+	RUN_TEST(RecoversAfterAWindowWithoutOverruns);
+
+	return GetTestFailureCount();
+}
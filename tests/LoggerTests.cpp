@@ -0,0 +1,124 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-discord-rich-presence, a DLL Plugin for
+// SimCity 4 that implements Discord rich presence support.
+//
+// Copyright (c) 2024 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#include "LogLevel.h"
+#include "TestAssert.h"
+#include <initializer_list>
+
+#ifdef LOGGER_TESTS_WRITE_LOG_FILE
+#include "Logger.h"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#endif // LOGGER_TESTS_WRITE_LOG_FILE
+
+namespace
+{
+	void DefaultLevelIncludesErrors()
+	{
+		CHECK(IsLogLevelEnabled(DefaultLogLevel, LogLevel::Error));
+		CHECK(IsLogLevelEnabled(DefaultLogLevel, LogLevel::Info));
+		CHECK(!IsLogLevelEnabled(DefaultLogLevel, LogLevel::Debug));
+		CHECK(!IsLogLevelEnabled(DefaultLogLevel, LogLevel::Trace));
+	}
+
+	void EveryLevelIncludesErrors()
+	{
+		for (LogLevel level : { LogLevel::Error, LogLevel::Info, LogLevel::Debug, LogLevel::Trace })
+		{
+			CHECK(IsLogLevelEnabled(level, LogLevel::Error));
+		}
+
+		CHECK(!IsLogLevelEnabled(LogLevel::Error, LogLevel::Info));
+		CHECK(IsLogLevelEnabled(LogLevel::Trace, LogLevel::Debug));
+	}
+
+	void ErrorsAreCompiledIntoEveryConfiguration()
+	{
+		CHECK(static_cast<int32_t>(LogLevel::Error) <= LOG_MAX_COMPILED_LEVEL);
+		CHECK(static_cast<int32_t>(DefaultLogLevel) <= LOG_MAX_COMPILED_LEVEL);
+	}
+
+#ifdef LOGGER_TESTS_WRITE_LOG_FILE
+	std::string ReadFile(const std::filesystem::path& path)
+	{
+		std::ifstream stream(path);
+		std::stringstream contents;
+		contents << stream.rdbuf();
+
+		return contents.str();
+	}
+
+	const std::filesystem::path LogFilePath = std::filesystem::temp_directory_path() / "SC4DiscordRichPresenceLoggerTests.log";
+
+	void ErrorIsWrittenAtTheDefaultLevel()
+	{
+		Logger& logger = Logger::GetInstance();
+		logger.Init(LogFilePath, DefaultLogLevel, false);
+
+		LOG_ERROR("An error at the default level.");
+		LOG_INFO("An info message at the default level.");
+		LOG_DEBUG("A debug message at the default level.");
+
+		const std::string logFile = ReadFile(LogFilePath);
+
+		CHECK(logFile.find("An error at the default level.") != std::string::npos);
+		CHECK(logFile.find("An info message at the default level.") != std::string::npos);
+		CHECK(logFile.find("A debug message at the default level.") == std::string::npos);
+	}
+
+	void TemplateErrorIsWrittenAtTheDefaultLevel()
+	{
+		// The message that CompileStatusTemplates writes for a rejected template.
+		LOG_ERROR("Invalid {} template for {}: {}", "CityStatusTemplates", "TotalFunds", "Missing } after {");
+
+		const std::string logFile = ReadFile(LogFilePath);
+
+		CHECK(logFile.find("Invalid CityStatusTemplates template for TotalFunds: Missing } after {") != std::string::npos);
+	}
+
+	void ErrorIsWrittenToTheFlightRecorder()
+	{
+		const std::filesystem::path recorderPath = std::filesystem::temp_directory_path() / "SC4DiscordRichPresenceLoggerTests.bin";
+
+		Logger& logger = Logger::GetInstance();
+
+		CHECK(logger.EnableFlightRecorder(recorderPath, 4096));
+
+		LOG_ERROR("Discord closed the connection: {}", "{\"code\":4000}");
+
+		logger.DisableFlightRecorder();
+
+		std::stringstream events;
+
+		CHECK(!FlightRecorder::WasSessionInterrupted(recorderPath));
+		CHECK(FlightRecorder::Decode(recorderPath, events));
+		CHECK(events.str().find("[Error] Discord closed the connection: {\"code\":4000}") != std::string::npos);
+		CHECK(ReadFile(LogFilePath).find("Discord closed the connection") != std::string::npos);
+	}
+#endif // LOGGER_TESTS_WRITE_LOG_FILE
+}
+
+int main()
+{
+	RUN_TEST(DefaultLevelIncludesErrors);
+	RUN_TEST(EveryLevelIncludesErrors);
+	RUN_TEST(ErrorsAreCompiledIntoEveryConfiguration);
+#ifdef LOGGER_TESTS_WRITE_LOG_FILE
+	RUN_TEST(ErrorIsWrittenAtTheDefaultLevel);
+	RUN_TEST(TemplateErrorIsWrittenAtTheDefaultLevel);
+	RUN_TEST(ErrorIsWrittenToTheFlightRecorder);
+#endif // LOGGER_TESTS_WRITE_LOG_FILE
+
+	return GetTestFailureCount();
+}
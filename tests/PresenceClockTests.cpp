@@ -0,0 +1,200 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-discord-rich-presence, a DLL Plugin for
+// SimCity 4 that implements Discord rich presence support.
+//
+// Copyright (c) 2024 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#include "ActivityUpdatePipeline.h"
+#include "FakePresenceClock.h"
+#include "StatusScheduler.h"
+#include "TaskScheduler.h"
+#include "TestAssert.h"
+#include <string>
+#include <vector>
+
+namespace
+{
+	void GetUnixTimeUsesTheSystemTime()
+	{
+		FakePresenceClock clock;
+
+		CHECK(clock.GetUnixTime() == 1700000000);
+
+		clock.Advance(std::chrono::milliseconds(2500));
+
+		CHECK(clock.GetUnixTime() == 1700000002);
+	}
+
+	void DefaultClockIsMonotonic()
+	{
+		const PresenceClock& clock = PresenceClock::GetDefault();
+
+		const PresenceClock::SteadyTimePoint first = clock.GetSteadyTime();
+		const PresenceClock::SteadyTimePoint second = clock.GetSteadyTime();
+
+		CHECK(second >= first);
+		CHECK(clock.GetUnixTime() > 0);
+	}
+
+	// Records the activity updates that the pipeline sends, Discord responds
+	// to each request on the next tick.
+	class RecordingActivitySender final : public IDiscordActivitySender
+	{
+	public:
+		explicit RecordingActivitySender(const PresenceClock& clock)
+			: clock(clock),
+			  sendTimes(),
+			  sentStates(),
+			  pendingRequestId(0),
+			  nextRequestId(1)
+		{
+		}
+
+		bool IsReady() const override
+		{
+			return true;
+		}
+
+		uint64_t UpdateActivity(const DiscordActivity& activity) override
+		{
+			sendTimes.push_back(clock.GetSteadyTime());
+			sentStates.push_back(activity.GetState());
+
+			pendingRequestId = nextRequestId++;
+			return pendingRequestId;
+		}
+
+		const PresenceClock& clock;
+		std::vector<PresenceClock::SteadyTimePoint> sendTimes;
+		std::vector<std::string> sentStates;
+		uint64_t pendingRequestId;
+		uint64_t nextRequestId;
+	};
+
+	struct RotationState
+	{
+		const PresenceClock& clock;
+		TaskScheduler& taskScheduler;
+		StatusScheduler& statusScheduler;
+		ActivityUpdatePipeline& pipeline;
+		std::vector<size_t> shownStatuses;
+	};
+
+	const char* const StatusNames[] = { "Population", "Funds", "Mayor rating" };
+
+	// Checks for the next status once a second, like the service's status selection task.
+	ScheduledTask StatusRotationTask(RotationState& state)
+	{
+		while (true)
+		{
+			co_await state.taskScheduler.Delay(std::chrono::seconds(1));
+
+			size_t index = 0;
+
+			if (state.statusScheduler.SelectNext(index, state.clock.GetSystemTime()))
+			{
+				state.statusScheduler.MarkShown(index, state.clock.GetSystemTime());
+				state.shownStatuses.push_back(index);
+
+				DiscordActivity activity;
+				activity.SetState(StatusNames[index]);
+				state.pipeline.Submit(activity);
+			}
+		}
+	}
+
+	void StatusRotationRunsForSeveralSimulatedDays()
+	{
+		constexpr std::chrono::hours SimulatedDuration(72);
+		constexpr std::chrono::milliseconds TickInterval(250);
+		constexpr std::chrono::seconds RotationInterval(30);
+
+		FakePresenceClock clock;
+		RecordingActivitySender sender(clock);
+		ActivityUpdatePipeline pipeline(sender, clock);
+		StatusScheduler statusScheduler(3, RotationInterval);
+		TaskScheduler taskScheduler;
+		RotationState state{ clock, taskScheduler, statusScheduler, pipeline, {} };
+
+		statusScheduler.Reset(0, clock.GetSystemTime());
+		taskScheduler.Tick(clock.GetSteadyTime());
+		taskScheduler.Start(StatusRotationTask(state));
+
+		const PresenceClock::SteadyTimePoint endTime = clock.GetSteadyTime() + SimulatedDuration;
+		uint64_t requestCount = 0;
+
+		while (clock.GetSteadyTime() < endTime)
+		{
+			clock.Advance(TickInterval);
+
+			if (sender.pendingRequestId != 0)
+			{
+				// Every 20th request times out, so the retry path is also exercised.
+				requestCount++;
+				pipeline.RequestCompleted(
+					sender.pendingRequestId,
+					(requestCount % 20) == 0 ? DiscordRequestResult::TimedOut : DiscordRequestResult::Ok);
+				sender.pendingRequestId = 0;
+			}
+
+			taskScheduler.Tick(clock.GetSteadyTime());
+			pipeline.Send();
+		}
+
+		// The unchanged statuses are shown in their rotation order.
+		int rotationMismatches = 0;
+
+		for (size_t i = 0; i < state.shownStatuses.size(); i++)
+		{
+			if (state.shownStatuses[i] != (i + 1) % 3)
+			{
+				rotationMismatches++;
+			}
+		}
+
+		CHECK(rotationMismatches == 0);
+
+		// The status changes when the 30 second interval has elapsed at the
+		// next one second check.
+		const size_t simulatedSeconds = static_cast<size_t>(std::chrono::seconds(SimulatedDuration).count());
+
+		CHECK(state.shownStatuses.size() >= simulatedSeconds / 31);
+		CHECK(state.shownStatuses.size() <= simulatedSeconds / 30);
+
+		// Discord requires at least 5 seconds between the activity updates.
+		int rateLimitViolations = 0;
+
+		for (size_t i = 1; i < sender.sendTimes.size(); i++)
+		{
+			if ((sender.sendTimes[i] - sender.sendTimes[i - 1]) < std::chrono::seconds(5))
+			{
+				rateLimitViolations++;
+			}
+		}
+
+		CHECK(rateLimitViolations == 0);
+
+		// Each status change is sent once, and each timed out request is retried
+		// once unless the next status replaced it first.
+		const size_t statusCount = state.shownStatuses.size();
+
+		CHECK(sender.sendTimes.size() >= statusCount);
+		CHECK(sender.sendTimes.size() <= statusCount + (statusCount / 19) + 1);
+		CHECK(sender.sentStates.back() == StatusNames[state.shownStatuses.back()]);
+	}
+}
+
+int main()
+{
+	RUN_TEST(GetUnixTimeUsesTheSystemTime);
+	RUN_TEST(DefaultClockIsMonotonic);
+	RUN_TEST(StatusRotationRunsForSeveralSimulatedDays);
+
+	return GetTestFailureCount();
+}
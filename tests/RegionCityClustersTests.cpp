@@ -0,0 +1,273 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-discord-rich-presence, a DLL Plugin for
+// SimCity 4 that implements Discord rich presence support.
+//
+// Copyright (c) 2024 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#include "RegionCityClusters.h"
+#include "TestAssert.h"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace
+{
+	struct TestCity
+	{
+		uint32_t x;
+		uint32_t y;
+		uint32_t size;
+	};
+
+	bool SharesEdge(const TestCity& a, const TestCity& b)
+	{
+		const bool rowsOverlap = a.y < b.y + b.size && b.y < a.y + a.size;
+		const bool columnsOverlap = a.x < b.x + b.size && b.x < a.x + a.size;
+
+		return (rowsOverlap && (a.x + a.size == b.x || b.x + b.size == a.x))
+			|| (columnsOverlap && (a.y + a.size == b.y || b.y + b.size == a.y));
+	}
+
+	// Compares the clusters with a pairwise edge check and a flood fill.
+	int CountMismatches(const std::vector<TestCity>& testCities, const RegionCityClusters& clusters)
+	{
+		const size_t cityCount = testCities.size();
+		std::vector<int> labels(cityCount, -1);
+		uint32_t expectedStandalone = 0;
+		uint32_t expectedClusters = 0;
+		uint32_t expectedLargest = 0;
+
+		for (size_t start = 0; start < cityCount; start++)
+		{
+			if (labels[start] >= 0)
+			{
+				continue;
+			}
+
+			std::vector<size_t> pending{ start };
+			uint32_t size = 0;
+			labels[start] = static_cast<int>(start);
+
+			while (!pending.empty())
+			{
+				const size_t city = pending.back();
+				pending.pop_back();
+				size++;
+
+				for (size_t other = 0; other < cityCount; other++)
+				{
+					if (labels[other] < 0 && SharesEdge(testCities[city], testCities[other]))
+					{
+						labels[other] = static_cast<int>(start);
+						pending.push_back(other);
+					}
+				}
+			}
+
+			if (size == 1)
+			{
+				expectedStandalone++;
+			}
+			else
+			{
+				expectedClusters++;
+			}
+
+			expectedLargest = std::max(expectedLargest, size);
+		}
+
+		int mismatches = 0;
+
+		if (clusters.GetCityCount() != cityCount)
+		{
+			mismatches++;
+		}
+
+		if (clusters.GetStandaloneCityCount() != expectedStandalone)
+		{
+			mismatches++;
+		}
+
+		if (clusters.GetBorderingCityCount() != cityCount - expectedStandalone)
+		{
+			mismatches++;
+		}
+
+		if (clusters.GetClusterCount() != expectedClusters)
+		{
+			mismatches++;
+		}
+
+		if (clusters.GetLargestClusterSize() != expectedLargest)
+		{
+			mismatches++;
+		}
+
+		return mismatches;
+	}
+
+	void EmptyRegionHasNoClusters()
+	{
+		RegionCityClusters clusters;
+		clusters.Reset(16, 16);
+
+		CHECK(clusters.GetCityCount() == 0);
+		CHECK(clusters.GetBorderingCityCount() == 0);
+		CHECK(clusters.GetStandaloneCityCount() == 0);
+		CHECK(clusters.GetClusterCount() == 0);
+		CHECK(clusters.GetLargestClusterSize() == 0);
+	}
+
+	void CornersDoNotConnectCities()
+	{
+		RegionCityClusters clusters;
+		clusters.Reset(16, 16);
+
+		clusters.AddCity(0, 0, 4);
+		clusters.AddCity(4, 4, 4);
+
+		CHECK(clusters.GetStandaloneCityCount() == 2);
+		CHECK(clusters.GetClusterCount() == 0);
+		CHECK(clusters.GetLargestClusterSize() == 1);
+	}
+
+	void LaterCityJoinsTwoClusters()
+	{
+		RegionCityClusters clusters;
+		clusters.Reset(16, 16);
+
+		// Two pairs of cities with a gap between them.
+		clusters.AddCity(0, 0, 2);
+		clusters.AddCity(0, 2, 2);
+		clusters.AddCity(4, 0, 2);
+		clusters.AddCity(4, 2, 2);
+
+		CHECK(clusters.GetClusterCount() == 2);
+		CHECK(clusters.GetLargestClusterSize() == 2);
+
+		// A city that fills the gap is on the left edge of one pair and the right edge of the other.
+		clusters.AddCity(2, 0, 2);
+
+		CHECK(clusters.GetClusterCount() == 1);
+		CHECK(clusters.GetLargestClusterSize() == 5);
+		CHECK(clusters.GetBorderingCityCount() == 5);
+		CHECK(clusters.GetStandaloneCityCount() == 0);
+	}
+
+	void CitiesAtTheRegionEdgeAreClipped()
+	{
+		RegionCityClusters clusters;
+		clusters.Reset(8, 8);
+
+		clusters.AddCity(6, 6, 4);
+		clusters.AddCity(6, 2, 4);
+		// Outside of the region.
+		clusters.AddCity(8, 0, 1);
+
+		CHECK(clusters.GetCityCount() == 2);
+		CHECK(clusters.GetClusterCount() == 1);
+		CHECK(clusters.GetLargestClusterSize() == 2);
+	}
+
+	void ResetRemovesTheCities()
+	{
+		RegionCityClusters clusters;
+		clusters.Reset(8, 8);
+		clusters.AddCity(0, 0, 4);
+		clusters.AddCity(4, 0, 4);
+
+		clusters.Reset(8, 8);
+		clusters.AddCity(0, 4, 4);
+
+		CHECK(clusters.GetCityCount() == 1);
+		CHECK(clusters.GetStandaloneCityCount() == 1);
+		CHECK(clusters.GetClusterCount() == 0);
+		CHECK(clusters.GetLargestClusterSize() == 1);
+	}
+
+	void MatchesAFloodFillOfRandomRegions()
+	{
+		constexpr uint32_t RegionSize = 64;
+		constexpr uint32_t CitySizes[] = { 1, 2, 4 };
+
+		std::mt19937 random(4242);
+		std::uniform_int_distribution<uint32_t> sizeDistribution(0, 2);
+		std::uniform_int_distribution<uint32_t> positionDistribution(0, RegionSize - 1);
+
+		int mismatches = 0;
+
+		for (int region = 0; region < 40; region++)
+		{
+			// The cities are placed on an occupancy grid so that they do not overlap,
+			// the same as the city tiles in a game region.
+			std::vector<bool> occupied(RegionSize * RegionSize, false);
+			std::vector<TestCity> testCities;
+			RegionCityClusters clusters;
+			clusters.Reset(RegionSize, RegionSize);
+
+			for (int attempt = 0; attempt < 600; attempt++)
+			{
+				const uint32_t size = CitySizes[sizeDistribution(random)];
+				const uint32_t x = positionDistribution(random) / size * size;
+				const uint32_t y = positionDistribution(random) / size * size;
+				bool free = true;
+
+				for (uint32_t row = y; row < y + size && free; row++)
+				{
+					for (uint32_t column = x; column < x + size; column++)
+					{
+						if (occupied[(row * RegionSize) + column])
+						{
+							free = false;
+							break;
+						}
+					}
+				}
+
+				if (!free)
+				{
+					continue;
+				}
+
+				for (uint32_t row = y; row < y + size; row++)
+				{
+					for (uint32_t column = x; column < x + size; column++)
+					{
+						occupied[(row * RegionSize) + column] = true;
+					}
+				}
+
+				testCities.push_back(TestCity{ x, y, size });
+				clusters.AddCity(x, y, size);
+
+				// The statistics are checked after every 25 cities because they are updated incrementally.
+				if ((testCities.size() % 25) == 0)
+				{
+					mismatches += CountMismatches(testCities, clusters);
+				}
+			}
+
+			mismatches += CountMismatches(testCities, clusters);
+		}
+
+		CHECK(mismatches == 0);
+	}
+}
+
+int main()
+{
+	RUN_TEST(EmptyRegionHasNoClusters);
+	RUN_TEST(CornersDoNotConnectCities);
+	RUN_TEST(LaterCityJoinsTwoClusters);
+	RUN_TEST(CitiesAtTheRegionEdgeAreClipped);
+	RUN_TEST(ResetRemovesTheCities);
+	RUN_TEST(MatchesAFloodFillOfRandomRegions);
+
+	return GetTestFailureCount();
+}
@@ -0,0 +1,130 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-discord-rich-presence, a DLL Plugin for
+// SimCity 4 that implements Discord rich presence support.
+//
+// Copyright (c) 2024 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#include "RegionTileOccupancy.h"
+#include "TestAssert.h"
+#include <random>
+#include <vector>
+
+namespace
+{
+	void EmptyGridHasNoTiles()
+	{
+		RegionTileOccupancy occupancy;
+		CHECK(occupancy.GetCount() == 0);
+
+		occupancy.Reset(100, 100);
+		CHECK(occupancy.GetCount() == 0);
+	}
+
+	void CountsTheCityTiles()
+	{
+		RegionTileOccupancy occupancy;
+		occupancy.Reset(256, 256);
+
+		occupancy.SetCityTiles(0, 0, 1);
+		occupancy.SetCityTiles(10, 10, 2);
+		occupancy.SetCityTiles(60, 20, 8);
+		CHECK(occupancy.GetCount() == 1 + 4 + 64);
+
+		// The overlapping tiles are only counted once.
+		occupancy.SetCityTiles(64, 20, 8);
+		CHECK(occupancy.GetCount() == 1 + 4 + 96);
+	}
+
+	void ClipsTheCitiesAtTheGridEdge()
+	{
+		RegionTileOccupancy occupancy;
+		occupancy.Reset(70, 10);
+
+		occupancy.SetCityTiles(66, 8, 8);
+		CHECK(occupancy.GetCount() == 4 * 2);
+
+		occupancy.SetCityTiles(70, 0, 4);
+		occupancy.SetCityTiles(0, 10, 4);
+		CHECK(occupancy.GetCount() == 4 * 2);
+	}
+
+	void ResetClearsTheTiles()
+	{
+		RegionTileOccupancy occupancy;
+		occupancy.Reset(64, 64);
+		occupancy.SetCityTiles(0, 0, 64);
+		CHECK(occupancy.GetCount() == 64 * 64);
+
+		occupancy.Reset(32, 32);
+		CHECK(occupancy.GetCount() == 0);
+	}
+
+	void MatchesAReferenceGrid()
+	{
+		constexpr uint32_t Width = 130;
+		constexpr uint32_t Height = 90;
+
+		std::mt19937 random(12345);
+		std::uniform_int_distribution<uint32_t> xDistribution(0, Width + 4);
+		std::uniform_int_distribution<uint32_t> yDistribution(0, Height + 4);
+		std::uniform_int_distribution<uint32_t> sizeDistribution(0, 2);
+
+		RegionTileOccupancy occupancy;
+		occupancy.Reset(Width, Height);
+
+		std::vector<bool> reference(Width * Height);
+		int mismatches = 0;
+
+		for (int iteration = 0; iteration < 300; iteration++)
+		{
+			const uint32_t x = xDistribution(random);
+			const uint32_t y = yDistribution(random);
+			// The city sizes are 1, 2 or 4 tiles.
+			const uint32_t size = 1u << sizeDistribution(random);
+
+			occupancy.SetCityTiles(x, y, size);
+
+			for (uint32_t row = y; row < y + size && row < Height; row++)
+			{
+				for (uint32_t column = x; column < x + size && column < Width; column++)
+				{
+					reference[(row * Width) + column] = true;
+				}
+			}
+
+			uint32_t expectedCount = 0;
+
+			for (bool tile : reference)
+			{
+				if (tile)
+				{
+					expectedCount++;
+				}
+			}
+
+			if (occupancy.GetCount() != expectedCount)
+			{
+				mismatches++;
+			}
+		}
+
+		CHECK(mismatches == 0);
+	}
+}
+
+int main()
+{
+	RUN_TEST(EmptyGridHasNoTiles);
+	RUN_TEST(CountsTheCityTiles);
+	RUN_TEST(ClipsTheCitiesAtTheGridEdge);
+	RUN_TEST(ResetClearsTheTiles);
+	RUN_TEST(MatchesAReferenceGrid);
+
+	return GetTestFailureCount();
+}
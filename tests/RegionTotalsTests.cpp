@@ -0,0 +1,84 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-discord-rich-presence, a DLL Plugin for
+// SimCity 4 that implements Discord rich presence support.
+//
+// Copyright (c) 2024 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#include "RegionTotals.h"
+#include "TestAssert.h"
+
+namespace
+{
+	void EstablishedCitiesAreAdded()
+	{
+		RegionTotals totals;
+
+		totals.AddCity(RegionalCitySummary{ true, 1000, 200, 300, 50000 });
+		totals.AddCity(RegionalCitySummary{ true, 2500, 400, 100, -7000 });
+
+		CHECK(totals.GetTotalResidentialPopulation() == 3500);
+		CHECK(totals.GetTotalCommercialJobs() == 600);
+		CHECK(totals.GetTotalIndustrialJobs() == 400);
+		CHECK(totals.GetTotalFunds() == 43000);
+		CHECK(totals.GetDevelopedCityCount() == 2);
+		CHECK(totals.GetUndevelopedCityCount() == 0);
+	}
+
+	void UnestablishedCitiesAreOnlyCounted()
+	{
+		RegionTotals totals;
+
+		totals.AddCity(RegionalCitySummary{ true, 1000, 200, 300, 50000 });
+		// The values of a city tile that has not been founded are ignored.
+		totals.AddCity(RegionalCitySummary{ false, 99, 99, 99, 99 });
+
+		CHECK(totals.GetTotalResidentialPopulation() == 1000);
+		CHECK(totals.GetTotalFunds() == 50000);
+		CHECK(totals.GetDevelopedCityCount() == 1);
+		CHECK(totals.GetUndevelopedCityCount() == 1);
+	}
+
+	void TotalsDoNotOverflow32Bits()
+	{
+		RegionTotals totals;
+
+		for (int i = 0; i < 4; i++)
+		{
+			totals.AddCity(RegionalCitySummary{ true, 0, 0, 0, 2000000000 });
+		}
+
+		CHECK(totals.GetTotalFunds() == 8000000000);
+	}
+
+	void ResetClearsTheTotals()
+	{
+		RegionTotals totals;
+		totals.AddCity(RegionalCitySummary{ true, 1000, 200, 300, 50000 });
+		totals.AddCity(RegionalCitySummary{ false, 0, 0, 0, 0 });
+
+		totals.Reset();
+
+		CHECK(totals.GetTotalResidentialPopulation() == 0);
+		CHECK(totals.GetTotalCommercialJobs() == 0);
+		CHECK(totals.GetTotalIndustrialJobs() == 0);
+		CHECK(totals.GetTotalFunds() == 0);
+		CHECK(totals.GetDevelopedCityCount() == 0);
+		CHECK(totals.GetUndevelopedCityCount() == 0);
+	}
+}
+
+int main()
+{
+	RUN_TEST(EstablishedCitiesAreAdded);
+	RUN_TEST(UnestablishedCitiesAreOnlyCounted);
+	RUN_TEST(TotalsDoNotOverflow32Bits);
+	RUN_TEST(ResetClearsTheTotals);
+
+	return GetTestFailureCount();
+}
@@ -0,0 +1,142 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-discord-rich-presence, a DLL Plugin for
+// SimCity 4 that implements Discord rich presence support.
+//
+// Copyright (c) 2024 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#include "StatusScheduler.h"
+#include "TestAssert.h"
+
+namespace
+{
+	typedef StatusScheduler::TimePoint TimePoint;
+
+	const TimePoint StartTime = TimePoint(std::chrono::seconds(1700000000));
+
+	void SelectNextWaitsForTheRotationInterval()
+	{
+		StatusScheduler scheduler(3, std::chrono::seconds(30));
+		scheduler.Reset(0, StartTime);
+
+		size_t index = 99;
+
+		CHECK(!scheduler.SelectNext(index, StartTime + std::chrono::seconds(29)));
+		CHECK(index == 99);
+		CHECK(scheduler.SelectNext(index, StartTime + std::chrono::seconds(30)));
+	}
+
+	void UnchangedStatusesRotateInOrder()
+	{
+		StatusScheduler scheduler(3, std::chrono::seconds(30));
+		scheduler.Reset(0, StartTime);
+
+		TimePoint now = StartTime;
+		size_t index = 0;
+
+		for (size_t expected : { 1, 2, 0, 1 })
+		{
+			now += std::chrono::seconds(30);
+
+			CHECK(scheduler.SelectNext(index, now));
+			CHECK(index == expected);
+
+			scheduler.MarkShown(index, now);
+		}
+	}
+
+	void ChangedStatusIsShownFirst()
+	{
+		StatusScheduler scheduler(4, std::chrono::seconds(30));
+
+		for (size_t i = 0; i < 4; i++)
+		{
+			scheduler.SetValue(i, 1000.0);
+		}
+		scheduler.Reset(0, StartTime);
+
+		// A 5% change is below the significance threshold, but it still
+		// ranks the status above the unchanged ones.
+		scheduler.SetValue(3, 1050.0);
+
+		size_t index = 0;
+
+		CHECK(scheduler.SelectNext(index, StartTime + std::chrono::seconds(30)));
+		CHECK(index == 3);
+	}
+
+	void SignificantChangeUsesTheThreshold()
+	{
+		StatusScheduler scheduler(3, std::chrono::seconds(30));
+
+		scheduler.SetValue(0, 1000.0);
+		scheduler.SetValue(1, 1000.0);
+		scheduler.SetValue(2, 1000.0);
+		scheduler.Reset(0, StartTime);
+
+		size_t index = 99;
+
+		scheduler.SetValue(1, 1050.0);
+		CHECK(!scheduler.SelectSignificantChange(index));
+
+		scheduler.SetValue(1, 1200.0);
+		scheduler.SetValue(2, 1500.0);
+		CHECK(scheduler.SelectSignificantChange(index));
+		CHECK(index == 2);
+
+		scheduler.MarkShown(2, StartTime);
+		CHECK(scheduler.SelectSignificantChange(index));
+		CHECK(index == 1);
+
+		scheduler.SetSignificanceThreshold(0.5);
+		CHECK(!scheduler.SelectSignificantChange(index));
+	}
+
+	void ChangeFromZeroIsMeasuredAgainstOne()
+	{
+		StatusScheduler scheduler(1, std::chrono::seconds(30));
+		scheduler.Reset(0, StartTime);
+
+		size_t index = 99;
+
+		scheduler.SetValue(0, 0.05);
+		CHECK(!scheduler.SelectSignificantChange(index));
+
+		scheduler.SetValue(0, 2.0);
+		CHECK(scheduler.SelectSignificantChange(index));
+		CHECK(index == 0);
+	}
+
+	void SetRotationIntervalIgnoresZero()
+	{
+		StatusScheduler scheduler(2, std::chrono::seconds(30));
+		scheduler.Reset(0, StartTime);
+		scheduler.SetRotationInterval(std::chrono::seconds(0));
+
+		size_t index = 0;
+
+		CHECK(!scheduler.SelectNext(index, StartTime + std::chrono::seconds(10)));
+
+		scheduler.SetRotationInterval(std::chrono::seconds(10));
+
+		CHECK(scheduler.SelectNext(index, StartTime + std::chrono::seconds(10)));
+		CHECK(index == 1);
+	}
+}
+
+int main()
+{
+	RUN_TEST(SelectNextWaitsForTheRotationInterval);
+	RUN_TEST(UnchangedStatusesRotateInOrder);
+	RUN_TEST(ChangedStatusIsShownFirst);
+	RUN_TEST(SignificantChangeUsesTheThreshold);
+	RUN_TEST(ChangeFromZeroIsMeasuredAgainstOne);
+	RUN_TEST(SetRotationIntervalIgnoresZero);
+
+	return GetTestFailureCount();
+}
@@ -0,0 +1,146 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-discord-rich-presence, a DLL Plugin for
+// SimCity 4 that implements Discord rich presence support.
+//
+// Copyright (c) 2024 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#include "StatusTemplate.h"
+#include "TestAssert.h"
+#include <cstdint>
+#include <limits>
+
+namespace
+{
+	const StatusTemplateVariable Variables[] =
+	{
+		{ "res_pop", StatusTemplateFormat::Number },
+		{ "funds", StatusTemplateFormat::Money },
+		{ "city_name", StatusTemplateFormat::Text },
+	};
+
+	constexpr size_t VariableCount = sizeof(Variables) / sizeof(Variables[0]);
+
+	std::string Render(const StatusTemplate& statusTemplate, int64_t population, int64_t funds, const char* cityName)
+	{
+		StatusTemplateValue values[VariableCount]{};
+		values[0].number = population;
+		values[1].number = funds;
+		values[2].text = cityName;
+
+		char buffer[128]{};
+		const size_t length = statusTemplate.Render(values, VariableCount, buffer, sizeof(buffer));
+
+		return std::string(buffer, length);
+	}
+
+	std::string CompileAndRender(const char* text, int64_t population, int64_t funds, const char* cityName)
+	{
+		StatusTemplate statusTemplate;
+		std::string errorMessage;
+
+		CHECK(statusTemplate.Compile(text, Variables, VariableCount, errorMessage));
+
+		return Render(statusTemplate, population, funds, cityName);
+	}
+
+	bool CompileFails(const char* text, const char* expectedError)
+	{
+		StatusTemplate statusTemplate;
+		std::string errorMessage;
+
+		const bool result = statusTemplate.Compile(text, Variables, VariableCount, errorMessage);
+
+		return !result && errorMessage == expectedError && statusTemplate.IsEmpty();
+	}
+
+	void RendersTheDefaultFormats()
+	{
+		CHECK(CompileAndRender("{res_pop} Sims, {funds}", 1234567, 1500, "") == "1,234,567 Sims, \xC2\xA7" "1,500");
+		CHECK(CompileAndRender("{city_name}", 0, 0, "Sunnyvale") == "Sunnyvale");
+		CHECK(CompileAndRender("{res_pop}", 999, 0, "") == "999");
+		CHECK(CompileAndRender("{res_pop}", 0, 0, "") == "0");
+	}
+
+	void RendersTheFormatOverrides()
+	{
+		CHECK(CompileAndRender("{res_pop:raw}", 1234567, 0, "") == "1234567");
+		CHECK(CompileAndRender("{res_pop:money}", 1000, 0, "") == "\xC2\xA7" "1,000");
+		CHECK(CompileAndRender("{funds:number}", 0, -2500, "") == "-2,500");
+		CHECK(CompileAndRender("{funds}", 0, -2500, "") == "-\xC2\xA7" "2,500");
+	}
+
+	void RendersTheInt64Limits()
+	{
+		CHECK(CompileAndRender("{res_pop:raw}", std::numeric_limits<int64_t>::min(), 0, "") == "-9223372036854775808");
+		CHECK(CompileAndRender("{res_pop}", std::numeric_limits<int64_t>::max(), 0, "") == "9,223,372,036,854,775,807");
+	}
+
+	void EscapedBracesAreLiterals()
+	{
+		CHECK(CompileAndRender("{{res_pop}}", 5, 0, "") == "{res_pop}");
+		CHECK(CompileAndRender("{{{res_pop}}}", 5, 0, "") == "{5}");
+		CHECK(CompileAndRender("a } b", 0, 0, "") == "a } b");
+		CHECK(CompileAndRender("trailing {", 0, 0, "") == "trailing {");
+		CHECK(CompileAndRender("", 0, 0, "") == "");
+	}
+
+	void InvalidTemplatesAreRejected()
+	{
+		CHECK(CompileFails("{res_pop", "Missing } after {"));
+		CHECK(CompileFails("{unknown}", "Unknown value: unknown"));
+		CHECK(CompileFails("{res_pop:hex}", "Unsupported format for res_pop: hex"));
+		CHECK(CompileFails("{city_name:number}", "Unsupported format for city_name: number"));
+	}
+
+	void FailedCompileClearsThePreviousTemplate()
+	{
+		StatusTemplate statusTemplate;
+		std::string errorMessage;
+
+		CHECK(statusTemplate.Compile("{res_pop}", Variables, VariableCount, errorMessage));
+		CHECK(!statusTemplate.IsEmpty());
+
+		CHECK(!statusTemplate.Compile("{res_pop", Variables, VariableCount, errorMessage));
+		CHECK(statusTemplate.IsEmpty());
+	}
+
+	void TruncatesAtACharacterBoundary()
+	{
+		StatusTemplate statusTemplate;
+		std::string errorMessage;
+
+		CHECK(statusTemplate.Compile("{funds}", Variables, VariableCount, errorMessage));
+
+		StatusTemplateValue values[VariableCount]{};
+		values[1].number = 1000;
+
+		// The two byte simoleon symbol does not fit after the first byte.
+		char buffer[3];
+		CHECK(statusTemplate.Render(values, VariableCount, buffer, 2) == 0);
+		CHECK(buffer[0] == '\0');
+
+		CHECK(statusTemplate.Render(values, VariableCount, buffer, 3) == 2);
+		CHECK(std::string(buffer) == "\xC2\xA7");
+
+		CHECK(statusTemplate.Render(values, VariableCount, nullptr, 0) == 0);
+	}
+}
+
+int main()
+{
+	RUN_TEST(RendersTheDefaultFormats);
+	RUN_TEST(RendersTheFormatOverrides);
+	RUN_TEST(RendersTheInt64Limits);
+	RUN_TEST(EscapedBracesAreLiterals);
+	RUN_TEST(InvalidTemplatesAreRejected);
+	RUN_TEST(FailedCompileClearsThePreviousTemplate);
+	RUN_TEST(TruncatesAtACharacterBoundary);
+
+	return GetTestFailureCount();
+}
@@ -0,0 +1,185 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-discord-rich-presence, a DLL Plugin for
+// SimCity 4 that implements Discord rich presence support.
+//
+// Copyright (c) 2024 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#include "TaskScheduler.h"
+#include "TestAssert.h"
+
+namespace
+{
+	typedef TaskScheduler::Clock Clock;
+
+	const Clock::time_point StartTime = Clock::time_point(std::chrono::hours(1));
+
+	// Counts the destruction of the coroutine frames that own it.
+	class DestructionCounter
+	{
+	public:
+		explicit DestructionCounter(int& count)
+			: count(count)
+		{
+		}
+
+		~DestructionCounter()
+		{
+			count++;
+		}
+
+	private:
+		int& count;
+	};
+
+	ScheduledTask DelayTask(TaskScheduler& scheduler, int& steps, int& destroyed)
+	{
+		DestructionCounter counter(destroyed);
+
+		steps++;
+		co_await scheduler.Delay(std::chrono::seconds(10));
+		steps++;
+		co_await scheduler.Delay(std::chrono::seconds(10));
+		steps++;
+	}
+
+	ScheduledTask MessageTask(TaskScheduler& scheduler, uint32_t messageType, int& received)
+	{
+		while (true)
+		{
+			co_await scheduler.WaitForMessage(messageType);
+			received++;
+		}
+	}
+
+	bool IsFlagSet(void* pContext)
+	{
+		return *static_cast<bool*>(pContext);
+	}
+
+	ScheduledTask ConditionTask(TaskScheduler& scheduler, bool& flag, int& steps)
+	{
+		co_await scheduler.WaitUntil(IsFlagSet, &flag);
+		steps++;
+		co_await scheduler.WaitUntil(IsFlagSet, &flag);
+		steps++;
+	}
+
+	void TaskStartsWhenItIsPassedToStart()
+	{
+		TaskScheduler scheduler;
+		int steps = 0;
+		int destroyed = 0;
+
+		ScheduledTask task = DelayTask(scheduler, steps, destroyed);
+		CHECK(steps == 0);
+
+		scheduler.Start(std::move(task));
+		CHECK(steps == 1);
+		CHECK(destroyed == 0);
+	}
+
+	void DelayIsMeasuredFromTheLastTick()
+	{
+		TaskScheduler scheduler;
+		int steps = 0;
+		int destroyed = 0;
+
+		scheduler.Tick(StartTime);
+		scheduler.Start(DelayTask(scheduler, steps, destroyed));
+
+		scheduler.Tick(StartTime + std::chrono::seconds(9));
+		CHECK(steps == 1);
+
+		scheduler.Tick(StartTime + std::chrono::seconds(10));
+		CHECK(steps == 2);
+
+		// The second delay starts at the tick that resumed the task.
+		scheduler.Tick(StartTime + std::chrono::seconds(19));
+		CHECK(steps == 2);
+
+		scheduler.Tick(StartTime + std::chrono::seconds(20));
+		CHECK(steps == 3);
+		CHECK(destroyed == 1);
+	}
+
+	void MessageResumesOnlyTheMatchingTasks()
+	{
+		TaskScheduler scheduler;
+		int firstReceived = 0;
+		int secondReceived = 0;
+
+		scheduler.Start(MessageTask(scheduler, 1, firstReceived));
+		scheduler.Start(MessageTask(scheduler, 2, secondReceived));
+
+		scheduler.Tick(StartTime + std::chrono::hours(1));
+		CHECK(firstReceived == 0);
+		CHECK(secondReceived == 0);
+
+		scheduler.NotifyMessage(1);
+		scheduler.NotifyMessage(1);
+		scheduler.NotifyMessage(3);
+
+		CHECK(firstReceived == 2);
+		CHECK(secondReceived == 0);
+	}
+
+	void ConditionIsCheckedOnEachTick()
+	{
+		TaskScheduler scheduler;
+		bool flag = false;
+		int steps = 0;
+
+		scheduler.Start(ConditionTask(scheduler, flag, steps));
+
+		scheduler.Tick(StartTime);
+		CHECK(steps == 0);
+
+		flag = true;
+		CHECK(steps == 0);
+
+		// The second wait does not suspend because the condition is already true.
+		scheduler.Tick(StartTime);
+		CHECK(steps == 2);
+	}
+
+	void ClearDestroysTheSuspendedTasks()
+	{
+		int destroyed = 0;
+		int steps = 0;
+
+		{
+			TaskScheduler scheduler;
+
+			scheduler.Start(DelayTask(scheduler, steps, destroyed));
+			scheduler.Clear();
+
+			CHECK(destroyed == 1);
+
+			scheduler.Tick(StartTime + std::chrono::hours(1));
+			CHECK(steps == 1);
+
+			scheduler.Start(DelayTask(scheduler, steps, destroyed));
+		}
+
+		// The destructor destroys the tasks that are still suspended.
+		CHECK(destroyed == 2);
+	}
+
+}
+
+int main()
+{
+	RUN_TEST(TaskStartsWhenItIsPassedToStart);
+	RUN_TEST(DelayIsMeasuredFromTheLastTick);
+	RUN_TEST(MessageResumesOnlyTheMatchingTasks);
+	RUN_TEST(ConditionIsCheckedOnEachTick);
+	RUN_TEST(ClearDestroysTheSuspendedTasks);
+
+	return GetTestFailureCount();
+}
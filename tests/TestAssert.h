@@ -0,0 +1,40 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-discord-rich-presence, a DLL Plugin for
+// SimCity 4 that implements Discord rich presence support.
+//
+// Copyright (c) 2024 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <cstdio>
+
+// A minimal test harness, each test program returns the number of failed checks.
+
+inline int& GetTestFailureCount()
+{
+	static int failureCount = 0;
+	return failureCount;
+}
+
+#define CHECK(condition) \
+	do \
+	{ \
+		if (!(condition)) \
+		{ \
+			std::fprintf(stderr, "%s(%d): CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+			GetTestFailureCount()++; \
+		} \
+	} while (0)
+
+#define RUN_TEST(test) \
+	do \
+	{ \
+		const int failuresBefore_ = GetTestFailureCount(); \
+		test(); \
+		std::printf("%s: %s\n", #test, GetTestFailureCount() == failuresBefore_ ? "passed" : "FAILED"); \
+	} while (0)
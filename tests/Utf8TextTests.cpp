@@ -0,0 +1,239 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-discord-rich-presence, a DLL Plugin for
+// SimCity 4 that implements Discord rich presence support.
+//
+// Copyright (c) 2024 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#include "Utf8Text.h"
+#include "TestAssert.h"
+#include <cstdint>
+#include <random>
+
+namespace
+{
+	// A straightforward decoder that the optimized validator is compared against.
+	bool IsValidReference(const uint8_t* text, size_t length)
+	{
+		size_t i = 0;
+
+		while (i < length)
+		{
+			const uint8_t lead = text[i];
+			size_t sequenceLength = 0;
+			uint32_t codePoint = 0;
+
+			if (lead < 0x80)
+			{
+				i++;
+				continue;
+			}
+			else if ((lead & 0xE0) == 0xC0)
+			{
+				sequenceLength = 2;
+				codePoint = lead & 0x1F;
+			}
+			else if ((lead & 0xF0) == 0xE0)
+			{
+				sequenceLength = 3;
+				codePoint = lead & 0x0F;
+			}
+			else if ((lead & 0xF8) == 0xF0)
+			{
+				sequenceLength = 4;
+				codePoint = lead & 0x07;
+			}
+			else
+			{
+				return false;
+			}
+
+			if ((length - i) < sequenceLength)
+			{
+				return false;
+			}
+
+			for (size_t j = 1; j < sequenceLength; j++)
+			{
+				if ((text[i + j] & 0xC0) != 0x80)
+				{
+					return false;
+				}
+
+				codePoint = (codePoint << 6) | (text[i + j] & 0x3F);
+			}
+
+			const uint32_t minimumCodePoint = sequenceLength == 2 ? 0x80 : sequenceLength == 3 ? 0x800 : 0x10000;
+
+			if (codePoint < minimumCodePoint
+				|| codePoint > 0x10FFFF
+				|| (codePoint >= 0xD800 && codePoint <= 0xDFFF))
+			{
+				return false;
+			}
+
+			i += sequenceLength;
+		}
+
+		return true;
+	}
+
+	bool IsValid(const std::string& text)
+	{
+		return Utf8Text::IsValid(text.data(), text.size());
+	}
+
+	void IsValidAcceptsWellFormedText()
+	{
+		CHECK(IsValid(""));
+		CHECK(IsValid("Sunnyvale"));
+		CHECK(IsValid("Caf\xC3\xA9"));
+		CHECK(IsValid("\xE2\x82\xAC"));
+		CHECK(IsValid("\xF0\x9F\x8F\x99"));
+		CHECK(IsValid("\xEF\xBF\xBF"));
+		CHECK(IsValid("\xF4\x8F\xBF\xBF"));
+	}
+
+	void IsValidRejectsMalformedText()
+	{
+		// An e with an acute accent in Windows-1252.
+		CHECK(!IsValid("Caf\xE9"));
+		// A lone continuation byte.
+		CHECK(!IsValid("\x80"));
+		// Overlong encodings.
+		CHECK(!IsValid("\xC0\xAF"));
+		CHECK(!IsValid("\xE0\x80\xAF"));
+		CHECK(!IsValid("\xF0\x80\x80\xAF"));
+		// A UTF-16 surrogate.
+		CHECK(!IsValid("\xED\xA0\x80"));
+		// Above U+10FFFF.
+		CHECK(!IsValid("\xF4\x90\x80\x80"));
+		CHECK(!IsValid("\xF5\x80\x80\x80"));
+		// Truncated sequences.
+		CHECK(!IsValid("\xE2\x82"));
+		CHECK(!IsValid("\xE2\x82" "A"));
+	}
+
+	void IsValidChecksEveryPositionOfLongText()
+	{
+		// The ASCII prefix is skipped 16 bytes at a time, so the invalid byte is
+		// placed before, inside and after the first full block.
+		for (size_t position = 0; position < 40; position++)
+		{
+			std::string text(40, 'a');
+			text[position] = '\xE9';
+
+			CHECK(!IsValid(text));
+
+			text.replace(position, 1, "\xC3\xA9");
+
+			CHECK(IsValid(text));
+		}
+	}
+
+	void IsValidMatchesTheReferenceForShortSequences()
+	{
+		uint8_t text[3];
+		int mismatches = 0;
+
+		for (uint32_t value = 0; value < 0x1000000; value++)
+		{
+			text[0] = static_cast<uint8_t>(value >> 16);
+			text[1] = static_cast<uint8_t>(value >> 8);
+			text[2] = static_cast<uint8_t>(value);
+
+			for (size_t length = 1; length <= 3; length++)
+			{
+				// The shorter lengths only need to be checked once per prefix.
+				if (length < 3 && (value & ((1u << (8 * (3 - length))) - 1)) != 0)
+				{
+					continue;
+				}
+
+				const bool expected = IsValidReference(text, length);
+				const bool actual = Utf8Text::IsValid(reinterpret_cast<const char*>(text), length);
+
+				if (expected != actual)
+				{
+					mismatches++;
+				}
+			}
+		}
+
+		CHECK(mismatches == 0);
+	}
+
+	void IsValidMatchesTheReferenceForRandomText()
+	{
+		std::mt19937 random(12345);
+		std::uniform_int_distribution<int> lengthDistribution(0, 64);
+		std::uniform_int_distribution<int> byteDistribution(0, 255);
+		int mismatches = 0;
+
+		for (int iteration = 0; iteration < 200000; iteration++)
+		{
+			uint8_t text[64];
+			const size_t length = static_cast<size_t>(lengthDistribution(random));
+
+			for (size_t i = 0; i < length; i++)
+			{
+				// Most of the bytes are ASCII or continuation bytes, so that some
+				// of the longer texts are valid.
+				const int value = byteDistribution(random);
+
+				text[i] = static_cast<uint8_t>(value < 128 ? value : value < 192 ? 0x80 | (value & 0x3F) : value);
+			}
+
+			const bool expected = IsValidReference(text, length);
+			const bool actual = Utf8Text::IsValid(reinterpret_cast<const char*>(text), length);
+
+			if (expected != actual)
+			{
+				mismatches++;
+			}
+		}
+
+		CHECK(mismatches == 0);
+	}
+
+	void ConvertsWindows1252()
+	{
+		const char text[] = "Caf\xE9 \x80\x81\x9F";
+
+		CHECK(Utf8Text::FromWindows1252(text, sizeof(text) - 1) == "Caf\xC3\xA9 \xE2\x82\xAC\xEF\xBF\xBD\xC5\xB8");
+		CHECK(Utf8Text::ToValidUtf8(text, sizeof(text) - 1) == "Caf\xC3\xA9 \xE2\x82\xAC\xEF\xBF\xBD\xC5\xB8");
+		CHECK(Utf8Text::ToValidUtf8("Caf\xC3\xA9", 5) == "Caf\xC3\xA9");
+	}
+
+	void TruncatesAtACharacterBoundary()
+	{
+		// A 1, 2, 3 and 4 byte character.
+		const char text[] = "a\xC3\xA9\xE2\x82\xAC\xF0\x9F\x8F\x99";
+		const size_t length = sizeof(text) - 1;
+
+		const size_t expected[] = { 0, 1, 1, 3, 3, 3, 6, 6, 6, 6, 10, 10 };
+
+		for (size_t maxLength = 0; maxLength < sizeof(expected) / sizeof(expected[0]); maxLength++)
+		{
+			CHECK(Utf8Text::FindTruncationPoint(text, length, maxLength) == expected[maxLength]);
+		}
+	}
+}
+
+int main()
+{
+	RUN_TEST(IsValidAcceptsWellFormedText);
+	RUN_TEST(IsValidRejectsMalformedText);
+	RUN_TEST(IsValidChecksEveryPositionOfLongText);
+	RUN_TEST(IsValidMatchesTheReferenceForShortSequences);
+	RUN_TEST(IsValidMatchesTheReferenceForRandomText);
+	RUN_TEST(ConvertsWindows1252);
+	RUN_TEST(TruncatesAtACharacterBoundary);
+
+	return GetTestFailureCount();
+}